@@ -0,0 +1,204 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_kernels.h"
+#include "heatmap_quick.h"
+#include "pi_kernels.h"
+#include "text_output.h"
+
+// Batch/server mode: job specs are read line by line (from a file or stdin)
+// and run in this one process, so the OpenMP thread pool and the buffers
+// are reused across jobs. Every job produces exactly one output line as
+// soon as it finishes:
+//   heatmap <columns> <rows> <seed> <lower> <upper> <window_height> <verbose> <num_threads> <work_factor>
+//   quick   <columns> <rows> <seed> <lower> <upper> <window_height> <verbose> <num_threads> <work_factor>
+//   pi      <num_tasks> <num_threads> <lower> <upper> <seed>
+// Blank lines and lines starting with '#' are skipped.
+
+#define MAX_JOB_LINE 4096
+
+// Grow-only buffer: reallocated only when a job needs more than any before
+typedef struct {
+    void *data;
+    size_t capacity;
+} arena_block;
+
+typedef struct {
+    arena_block grid;
+    arena_block max_sums;
+    arena_block hotspots_per_row;
+} job_arena;
+
+static void *arena_reserve(arena_block *block, size_t bytes) {
+    if (bytes > block->capacity) {
+        // Grow by at least half so a slowly rising size does not reallocate every job
+        size_t capacity = block->capacity + block->capacity / 2;
+        capacity = (capacity > bytes) ? capacity : bytes;
+        capacity = (capacity + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        free(block->data);
+        block->data = aligned_alloc(CACHE_LINE_SIZE, capacity);
+        if (block->data == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        block->capacity = capacity;
+    }
+    return block->data;
+}
+
+static void arena_free(job_arena *arena) {
+    free(arena->grid.data);
+    free(arena->max_sums.data);
+    free(arena->hotspots_per_row.data);
+}
+
+// heatmap and quick jobs; returns 0, or -1 for invalid parameters
+static int run_heatmap_job(long job, const char *kind, const char *args, job_arena *arena) {
+    int cols, window_height, verbose, num_threads, work_factor;
+    long rows;
+    unsigned long seed, lower, upper;
+    int used = 0;
+    if (sscanf(args, "%d %ld %lu %lu %lu %d %d %d %d %n", &cols, &rows, &seed, &lower, &upper,
+               &window_height, &verbose, &num_threads, &work_factor, &used) != 9 || args[used] != '\0' ||
+        rows <= 0 || cols <= 0 || window_height <= 0 || window_height > rows || upper <= lower ||
+        num_threads <= 0 || work_factor < 0) {
+        return -1;
+    }
+    
+    double start_time = omp_get_wtime();
+    omp_set_num_threads(num_threads);
+    unsigned long *heatmap = (unsigned long*) arena_reserve(&arena->grid, (size_t)rows * cols * sizeof(unsigned long));
+    unsigned long long *max_sums = (unsigned long long*) arena_reserve(&arena->max_sums, cols * sizeof(unsigned long long));
+    padded_int *hotspots_per_row = (padded_int*) arena_reserve(&arena->hotspots_per_row, rows * sizeof(padded_int));
+    
+    long long total_hotspots = 0;
+    long early_exit_row = -1;
+    if (strcmp(kind, "quick") == 0) {
+        row_generator gen;
+        row_generator_init(&gen, cols, seed, lower, upper);
+        early_exit_row = quick_scan(heatmap, rows, cols, &gen, work_factor, hotspots_per_row, &total_hotspots);
+        row_generator_free(&gen);
+        if (early_exit_row == -1) {
+            #pragma omp parallel
+            {
+                window_sums_rows(heatmap, rows, cols, window_height, max_sums);
+            }
+        }
+    } else {
+        initialize_heatmap_into(heatmap, rows, cols, seed, lower, upper);
+        preprocess_heatmap(heatmap, rows, cols, work_factor);
+        total_hotspots = analyze_heatmap(heatmap, rows, cols, window_height, PART_A_ROWS, max_sums,
+                                         hotspots_per_row);
+    }
+    double elapsed_time = omp_get_wtime() - start_time;
+    
+    if (early_exit_row != -1) {
+        printf("%ld %s early_exit_row=%ld", job, kind, early_exit_row);
+    } else {
+        printf("%ld %s total_hotspots=%lld", job, kind, total_hotspots);
+        if (verbose) {
+            printf(" max_sums=");
+            write_sums(max_sums, cols);
+            printf(" hotspots_per_row=");
+            write_count_list(hotspots_per_row, rows);
+        }
+    }
+    printf(" seconds=%.6f\n", elapsed_time);
+    return 0;
+}
+
+static int run_pi_job(long job, const char *args) {
+    int num_tasks, num_threads;
+    unsigned long lower, upper, seed;
+    int used = 0;
+    if (sscanf(args, "%d %d %lu %lu %lu %n", &num_tasks, &num_threads, &lower, &upper, &seed, &used) != 5 ||
+        args[used] != '\0' || num_tasks <= 0 || num_threads <= 0 || upper <= lower) {
+        return -1;
+    }
+    
+    double start_time = omp_get_wtime();
+    omp_set_num_threads(num_threads);
+    pi_result result;
+    if (run_pi_tasks(num_tasks, num_threads, lower, upper, seed, NULL, &result) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    double elapsed_time = omp_get_wtime() - start_time;
+    
+    printf("%ld pi average_pi=%.10f tasks=%d per_thread=", job, result.average_pi, result.valid_tasks);
+    for (int i = 0; i < num_threads; i++) {
+        printf(i > 0 ? ",%d" : "%d", result.tasks_per_thread[i].count);
+    }
+    printf(" seconds=%.6f\n", elapsed_time);
+    pi_result_free(&result);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc > 2) {
+        fprintf(stderr, "Usage: %s [jobs_file]   (default: stdin)\n", argv[0]);
+        return 1;
+    }
+    
+    FILE *in = stdin;
+    if (argc == 2 && strcmp(argv[1], "-") != 0) {
+        in = fopen(argv[1], "r");
+        if (in == NULL) {
+            fprintf(stderr, "Error: Cannot open %s\n", argv[1]);
+            return 1;
+        }
+    }
+    
+    // Start the thread pool and resolve the hash variant before the first job
+    hash_selected();
+    #pragma omp parallel
+    {
+        (void)omp_get_thread_num();
+    }
+    
+    job_arena arena = { { NULL, 0 }, { NULL, 0 }, { NULL, 0 } };
+    char line[MAX_JOB_LINE];
+    long jobs = 0;
+    long failed = 0;
+    double start_time = omp_get_wtime();
+    
+    while (fgets(line, sizeof(line), in) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char kind[16];
+        int used = 0;
+        if (sscanf(line, " %15s %n", kind, &used) != 1 || kind[0] == '#') {
+            continue;
+        }
+        jobs++;
+        
+        const char *args = line + used;
+        int status;
+        if (strcmp(kind, "heatmap") == 0 || strcmp(kind, "quick") == 0) {
+            status = run_heatmap_job(jobs, kind, args, &arena);
+        } else if (strcmp(kind, "pi") == 0) {
+            status = run_pi_job(jobs, args);
+        } else {
+            status = -1;
+        }
+        if (status != 0) {
+            printf("%ld error Invalid parameters\n", jobs);
+            failed++;
+        }
+        
+        // One line per job, visible to the reader right away
+        fflush(stdout);
+    }
+    
+    double elapsed_time = omp_get_wtime() - start_time;
+    fprintf(stderr, "Batch: %ld job(s), %ld failed, %.4f s total, %.6f s per job\n", jobs, failed,
+            elapsed_time, (jobs > 0) ? elapsed_time / jobs : 0.0);
+    
+    arena_free(&arena);
+    if (in != stdin) {
+        fclose(in);
+    }
+    
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <x86intrin.h>
+#include "cpu_dispatch.h"
+#include "hash_kernels.h"
+
+// Cycles per cell of every preprocess variant, generic loop vs the kernel
+// specialized for the work factor (TSC cycles, single thread). Results of
+// all kernels are checked against the scalar reference first.
+
+#define FACTOR_VALUE(W) W,
+
+int compare_u64(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Median TSC cycles per cell of reps runs (after one warmup run)
+double cycles_per_cell(hash_row_fn kernel, unsigned long *values, size_t n, int work_factor,
+                       int reps, unsigned long long *ticks) {
+    kernel(values, n, work_factor);
+    for (int r = 0; r < reps; r++) {
+        unsigned long long start = __rdtsc();
+        kernel(values, n, work_factor);
+        ticks[r] = __rdtsc() - start;
+    }
+    qsort(ticks, reps, sizeof(unsigned long long), compare_u64);
+    return (double)ticks[reps / 2] / n;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <cells> <repetitions>\n", argv[0]);
+        return 1;
+    }
+    
+    long cells = strtol(argv[1], NULL, 10);
+    int reps = atoi(argv[2]);
+    if (cells <= 0 || reps <= 0) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        return 1;
+    }
+    
+    size_t n = (size_t)cells;
+    unsigned long *input = (unsigned long*) malloc(n * sizeof(unsigned long));
+    unsigned long *ref = (unsigned long*) malloc(n * sizeof(unsigned long));
+    unsigned long *values = (unsigned long*) malloc(n * sizeof(unsigned long));
+    unsigned long long *ticks = (unsigned long long*) malloc(reps * sizeof(unsigned long long));
+    if (input == NULL || ref == NULL || values == NULL || ticks == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    for (size_t i = 0; i < n; i++) {
+        input[i] = i * 0x9E3779B97F4A7C15UL + 42;
+    }
+    
+    // Specialized factors plus one that only has the generic loop
+    const int factors[] = { HASH_FIXED_FACTORS(FACTOR_VALUE) 7 };
+    const int num_factors = sizeof(factors) / sizeof(factors[0]);
+    cpu_isa isa = cpu_detect_isa();
+    
+    printf("Hash benchmark: cells=%ld, repetitions=%d, isa=%s\n\n", cells, reps, cpu_isa_name(isa));
+    printf("Variant | Work | Generic (cycles/cell) | Specialized (cycles/cell) | Speedup\n");
+    printf("--------|------|-----------------------|---------------------------|--------\n");
+    
+    int mismatch = 0;
+    for (int f = 0; f < num_factors; f++) {
+        int work_factor = factors[f];
+        memcpy(ref, input, n * sizeof(unsigned long));
+        hash_row_scalar(ref, n, work_factor);
+        
+        for (int v = HASH_SCALAR; v <= HASH_AVX512; v++) {
+            hash_variant variant = (hash_variant)v;
+            if ((variant == HASH_AVX2 && isa < ISA_AVX2) || (variant == HASH_AVX512 && isa < ISA_AVX512)) {
+                continue;
+            }
+            hash_row_fn generic = hash_kernel_generic(variant);
+            hash_row_fn fixed = hash_kernel(variant, work_factor);
+            
+            // Exactness of both kernels on the same input
+            hash_row_fn kernels[] = { generic, fixed };
+            for (int k = 0; k < 2; k++) {
+                memcpy(values, input, n * sizeof(unsigned long));
+                kernels[k](values, n, work_factor);
+                if (memcmp(values, ref, n * sizeof(unsigned long)) != 0) {
+                    printf("Mismatch: %s, work_factor=%d\n", hash_variant_name(variant), work_factor);
+                    mismatch = 1;
+                }
+            }
+            
+            double generic_cycles = cycles_per_cell(generic, values, n, work_factor, reps, ticks);
+            if (fixed == generic) {
+                printf("%-7s | %4d | %21.2f | %25s | %7s\n", hash_variant_name(variant), work_factor,
+                       generic_cycles, "-", "-");
+            } else {
+                double fixed_cycles = cycles_per_cell(fixed, values, n, work_factor, reps, ticks);
+                printf("%-7s | %4d | %21.2f | %25.2f | %6.2fx\n", hash_variant_name(variant), work_factor,
+                       generic_cycles, fixed_cycles, generic_cycles / fixed_cycles);
+            }
+        }
+    }
+    
+    if (mismatch) {
+        printf("\nError: kernel results differ\n");
+    }
+    
+    free(ticks);
+    free(values);
+    free(ref);
+    free(input);
+    
+    return mismatch;
+}
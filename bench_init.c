@@ -0,0 +1,156 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "heatmap_kernels.h"
+
+// Benchmark and exactness check for the heatmap generator (scalar
+// concatenate()/my_rand() reference vs the precomputed, vectorized rows)
+
+// Reference initialization with the scalar per-cell generator
+void initialize_reference(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                          unsigned long lower, unsigned long upper) {
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < rows; i++) {
+        generate_row_reference(&heatmap[(size_t)i * cols], i, cols, seed, lower, upper);
+    }
+}
+
+// Same loop as initialize_heatmap(), into a preallocated grid
+void initialize_vector(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                       unsigned long lower, unsigned long upper) {
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < rows; i++) {
+        generate_row(&gen, &heatmap[(size_t)i * cols], i);
+    }
+    row_generator_free(&gen);
+}
+
+// Compare both generators on rows [0, rows) for one parameter set
+int rows_match(long rows, int cols, unsigned long seed, unsigned long lower, unsigned long upper,
+               unsigned long *ref, unsigned long *row) {
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    int match = 1;
+    for (long i = 0; i < rows && match; i++) {
+        generate_row_reference(ref, i, cols, seed, lower, upper);
+        generate_row(&gen, row, i);
+        match = (memcmp(ref, row, cols * sizeof(unsigned long)) == 0);
+    }
+    row_generator_free(&gen);
+    if (!match) {
+        printf("Mismatch: seed=%lu, lower=%lu, upper=%lu\n", seed, lower, upper);
+    }
+    return match;
+}
+
+int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 5) {
+        fprintf(stderr, "Usage: %s <columns> <rows> <num_threads> <repetitions>\n", argv[0]);
+        return 1;
+    }
+    
+    int cols = atoi(argv[1]);
+    long rows = strtol(argv[2], NULL, 10);
+    int num_threads = atoi(argv[3]);
+    int reps = atoi(argv[4]);
+    
+    if (rows <= 0 || cols <= 0 || num_threads <= 0 || reps <= 0) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        return 1;
+    }
+    
+    omp_set_num_threads(num_threads);
+    
+    unsigned long *ref = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+    unsigned long *grid = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+    double *elapsed = (double*) malloc(reps * sizeof(double));
+    unsigned long *row = (unsigned long*) malloc(cols * sizeof(unsigned long));
+    if (ref == NULL || grid == NULL || elapsed == NULL || row == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    
+    printf("Init benchmark: columns=%d, rows=%ld, num_threads=%d, repetitions=%d\n\n",
+           cols, rows, num_threads, reps);
+    
+    // Exactness: edge ranges (empty, 1, powers of two, 64-bit extremes,
+    // divisors needing the add step) plus pseudo-random ranges of every width
+    int mismatch = 0;
+    int checked = 0;
+    const unsigned long edges[][3] = {
+        { 42, 0, 100 }, { 0, 0, 10 }, { 7, 5, 5 }, { 7, 9, 5 }, { 1, 0, 1 }, { 3, 0, 2 },
+        { 3, 0, 1UL << 20 }, { 5, 17, 17 + (1UL << 63) }, { 9, 0, ~0UL }, { 11, 1UL << 63, ~0UL },
+        { 13, 0, (1UL << 63) + 1 }, { 17, 0, 7 }, { 19, 3, 3 + 641 }, { 23, 0, 6700417 },
+        { 29, 100, 100 + 0xFFFFFFFFUL }, { 31, ~0UL - 3, ~0UL }
+    };
+    long check_rows = (rows < 8) ? rows : 8;
+    for (size_t k = 0; k < sizeof(edges) / sizeof(edges[0]); k++) {
+        mismatch |= !rows_match(check_rows, cols, edges[k][0], edges[k][1], edges[k][2], ref, row);
+        checked++;
+    }
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    for (int k = 0; k < 256; k++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        unsigned long range = (state >> (k % 64)) | 1UL;
+        range += (k & 1);
+        mismatch |= !rows_match(2, cols, state, k, k + range, ref, row);
+        checked++;
+    }
+    printf("Exactness: %d parameter sets %s\n\n", checked, mismatch ? "FAILED" : "identical");
+    
+    printf("Generator | Median (s) | Best (s) | Mcells/s (median)\n");
+    printf("----------|------------|----------|------------------\n");
+    
+    const char *names[] = { "scalar", "vector" };
+    double medians[2];
+    double cells = (double)rows * cols;
+    
+    for (int k = 0; k < 2; k++) {
+        // Warmup run (touches the pages), also used to verify the full grid
+        if (k == 0) {
+            initialize_reference(ref, rows, cols, 42, 0, 100);
+        } else {
+            initialize_vector(grid, rows, cols, 42, 0, 100);
+            if (memcmp(grid, ref, (size_t)rows * cols * sizeof(unsigned long)) != 0) {
+                mismatch = 1;
+            }
+        }
+        
+        for (int r = 0; r < reps; r++) {
+            double start_time = omp_get_wtime();
+            if (k == 0) {
+                initialize_reference(ref, rows, cols, 42, 0, 100);
+            } else {
+                initialize_vector(grid, rows, cols, 42, 0, 100);
+            }
+            elapsed[r] = omp_get_wtime() - start_time;
+        }
+        qsort(elapsed, reps, sizeof(double), compare_double);
+        medians[k] = elapsed[reps / 2];
+        
+        printf("%-9s | %10.6f | %8.6f | %16.1f\n", names[k], medians[k], elapsed[0], cells / medians[k] / 1e6);
+    }
+    
+    printf("\nSpeedup vector vs scalar: %.2fx\n", medians[0] / medians[1]);
+    if (mismatch) {
+        printf("Error: generated values differ\n");
+    }
+    
+    free(row);
+    free(elapsed);
+    free(grid);
+    free(ref);
+    
+    return mismatch;
+}
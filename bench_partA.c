@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "heatmap_kernels.h"
+
+// Benchmark for the two Part A kernels (column walk vs row-major sweep)
+
+// Run one Part A kernel inside a parallel region and return the elapsed time
+double time_part_a(part_a_kernel kernel, const unsigned long *heatmap, int rows, int cols,
+                   int window_height, unsigned long long *max_sums) {
+    double start_time = omp_get_wtime();
+    #pragma omp parallel
+    {
+        if (kernel == PART_A_COLUMNS) {
+            window_sums_columns(heatmap, rows, cols, window_height, max_sums);
+        } else {
+            window_sums_rows(heatmap, rows, cols, window_height, max_sums);
+        }
+    }
+    return omp_get_wtime() - start_time;
+}
+
+int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 6) {
+        fprintf(stderr, "Usage: %s <columns> <rows> <window_height> <num_threads> <repetitions>\n", argv[0]);
+        return 1;
+    }
+    
+    int cols = atoi(argv[1]);
+    int rows = atoi(argv[2]);
+    int window_height = atoi(argv[3]);
+    int num_threads = atoi(argv[4]);
+    int reps = atoi(argv[5]);
+    
+    if (rows <= 0 || cols <= 0 || window_height <= 0 || window_height > rows || num_threads <= 0 || reps <= 0) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        return 1;
+    }
+    
+    omp_set_num_threads(num_threads);
+    
+    // Hashed values, as Part A sees them in heatmap_analysis
+    unsigned long *heatmap = initialize_heatmap(rows, cols, 42, 0, 100);
+    preprocess_heatmap(heatmap, rows, cols, 1);
+    
+    unsigned long long *ref_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+    unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+    double *times = (double*) malloc(reps * sizeof(double));
+    if (ref_sums == NULL || max_sums == NULL || times == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    
+    printf("Part A benchmark: columns=%d, rows=%d, window_height=%d, num_threads=%d, repetitions=%d\n\n",
+           cols, rows, window_height, num_threads, reps);
+    printf("Kernel  | Median (s) | Best (s) | GB/s (median)\n");
+    printf("--------|------------|----------|--------------\n");
+    
+    const char *names[] = { "rows", "columns" };
+    part_a_kernel kernels[] = { PART_A_ROWS, PART_A_COLUMNS };
+    double medians[2];
+    int mismatch = 0;
+    
+    // Each grid element is read twice (entering and leaving the window)
+    double bytes = 2.0 * (double)rows * cols * sizeof(unsigned long);
+    
+    time_part_a(PART_A_COLUMNS, heatmap, rows, cols, window_height, ref_sums);
+    
+    for (int k = 0; k < 2; k++) {
+        // Warmup run, also used to verify the result
+        time_part_a(kernels[k], heatmap, rows, cols, window_height, max_sums);
+        if (memcmp(max_sums, ref_sums, cols * sizeof(unsigned long long)) != 0) {
+            mismatch = 1;
+        }
+        
+        for (int r = 0; r < reps; r++) {
+            times[r] = time_part_a(kernels[k], heatmap, rows, cols, window_height, max_sums);
+        }
+        qsort(times, reps, sizeof(double), compare_double);
+        medians[k] = times[reps / 2];
+        
+        printf("%-7s | %10.6f | %8.6f | %12.2f\n", names[k], medians[k], times[0], bytes / medians[k] / 1e9);
+    }
+    
+    printf("\nSpeedup rows vs columns: %.2fx\n", medians[1] / medians[0]);
+    if (mismatch) {
+        printf("Error: kernel results differ\n");
+    }
+    
+    free(times);
+    free(max_sums);
+    free(ref_sums);
+    free(heatmap);
+    
+    return mismatch;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <x86intrin.h>
+#include "cpu_dispatch.h"
+#include "pi_compute.h"
+
+// Cycles per sample of every pi kernel variant (TSC cycles, single thread)
+// and its deviation from the scalar reference, which must stay within
+// PI_KERNEL_TOLERANCE.
+
+int compare_u64(const void *a, const void *b) {
+    unsigned long long x = *(const unsigned long long*)a;
+    unsigned long long y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Median TSC cycles per sample of reps runs (after one warmup run)
+double cycles_per_sample(pi_sum_fn kernel, unsigned long precision, int reps,
+                         unsigned long long *ticks, double *pi) {
+    *pi = kernel(precision, 0, precision) * (1.0 / (double)precision);
+    for (int r = 0; r < reps; r++) {
+        unsigned long long start = __rdtsc();
+        volatile double value = kernel(precision, 0, precision);
+        ticks[r] = __rdtsc() - start;
+        (void)value;
+    }
+    qsort(ticks, reps, sizeof(unsigned long long), compare_u64);
+    return (double)ticks[reps / 2] / precision;
+}
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <precision> <repetitions>\n", argv[0]);
+        return 1;
+    }
+
+    long precision = strtol(argv[1], NULL, 10);
+    int reps = atoi(argv[2]);
+    if (precision <= 0 || reps <= 0) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        return 1;
+    }
+
+    unsigned long long *ticks = (unsigned long long*) malloc(reps * sizeof(unsigned long long));
+    if (ticks == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+
+    cpu_isa isa = cpu_detect_isa();
+    pi_kernel_select(PI_AUTO);
+
+    printf("Pi kernel benchmark: precision=%ld, repetitions=%d, isa=%s, auto=%s\n\n", precision, reps,
+           cpu_isa_name(isa), pi_variant_name(pi_kernel_selected()));
+    printf("Variant       | Cycles/sample | Speedup | Pi               | Rel. error\n");
+    printf("--------------|---------------|---------|------------------|-----------\n");
+
+    double reference_pi = 0.0;
+    double reference_cycles = 0.0;
+    int out_of_tolerance = 0;
+    for (int v = PI_SCALAR; v <= PI_AVX512_NEWTON; v++) {
+        pi_variant variant = (pi_variant)v;
+        if (((variant == PI_AVX2 || variant == PI_AVX2_NEWTON) && isa < ISA_AVX2) ||
+            ((variant == PI_AVX512 || variant == PI_AVX512_NEWTON) && isa < ISA_AVX512)) {
+            continue;
+        }
+        double pi;
+        double cycles = cycles_per_sample(pi_kernel(variant), precision, reps, ticks, &pi);
+        if (variant == PI_SCALAR) {
+            reference_pi = pi;
+            reference_cycles = cycles;
+        }
+        double error = fabs(pi - reference_pi) / reference_pi;
+        if (error > PI_KERNEL_TOLERANCE) {
+            out_of_tolerance = 1;
+        }
+        printf("%-13s | %13.3f | %6.2fx | %.14f | %.2e%s\n", pi_variant_name(variant), cycles,
+               reference_cycles / cycles, pi, error, (error > PI_KERNEL_TOLERANCE) ? " (!)" : "");
+    }
+
+    if (out_of_tolerance) {
+        printf("\nError: relative error above %.0e\n", PI_KERNEL_TOLERANCE);
+    }
+
+    free(ticks);
+
+    return out_of_tolerance;
+}
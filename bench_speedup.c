@@ -0,0 +1,709 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <omp.h>
+#include "heatmap_kernels.h"
+#include "heatmap_quick.h"
+#include "pi_kernels.h"
+
+// Speedup harness: runs the heatmap, quick and pi pipelines in-process over
+// a sweep of thread counts, grid sizes, work factors, window heights and
+// thread affinities, and reports median, stddev, speedup and efficiency
+// with 95% confidence intervals. Records are written as one JSON object per
+// line so that a baseline of one commit can be compared with another.
+
+#define MAX_LIST 64
+#define MAX_RECORDS 4096
+#define MAX_LINE 1024
+
+typedef enum { PROGRAM_HEATMAP, PROGRAM_QUICK, PROGRAM_PI } program_kind;
+
+static const char *program_names[] = { "heatmap", "quick", "pi" };
+
+typedef struct {
+    char program[16];
+    char affinity[16];
+    int threads;
+    char size[32];          // "CxR" for the heatmap programs, the task count for pi
+    int work_factor;        // 0 for pi
+    int window_height;      // 0 for pi
+    int reps;
+    double median;
+    double mean;
+    double stddev;
+    double ci95;            // half-width of the 95% interval of the mean
+    double speedup;         // vs the first thread count of the sweep
+    double speedup_ci95;
+    double efficiency;      // speedup per thread, relative to the first thread count
+    double atomics_per_task; // pi: atomic updates of the task budget per task (last run)
+} bench_record;
+
+typedef struct {
+    int programs[3];
+    int num_programs;
+    long threads[MAX_LIST];
+    int num_threads;
+    int sizes[MAX_LIST][2];
+    int num_sizes;
+    long works[MAX_LIST];
+    int num_works;
+    long windows[MAX_LIST];
+    int num_windows;
+    char affinities[MAX_LIST][16];
+    int num_affinities;
+    const char *places;
+    int reps;
+    int warmup;
+    unsigned long seed;
+    unsigned long lower;
+    unsigned long upper;
+    int pi_tasks;
+    unsigned long pi_lower;
+    unsigned long pi_upper;
+    pi_options pi_opts;
+} bench_config;
+
+// Two-sided 95% quantiles of Student's t for 1..30 degrees of freedom
+static const double t95[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+};
+
+static double t_quantile(int df) {
+    if (df <= 0) {
+        return 0.0;
+    }
+    return (df <= 30) ? t95[df - 1] : 1.960;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Median, mean, sample stddev and CI half-width of n samples (sorts them)
+static void summarize(double *samples, int n, bench_record *rec) {
+    qsort(samples, n, sizeof(double), compare_double);
+    rec->median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    double sum = 0.0;
+    for (int r = 0; r < n; r++) {
+        sum += samples[r];
+    }
+    rec->mean = sum / n;
+    double sq = 0.0;
+    for (int r = 0; r < n; r++) {
+        sq += (samples[r] - rec->mean) * (samples[r] - rec->mean);
+    }
+    rec->stddev = (n > 1) ? sqrt(sq / (n - 1)) : 0.0;
+    rec->ci95 = (n > 1) ? t_quantile(n - 1) * rec->stddev / sqrt((double)n) : 0.0;
+}
+
+// Full heatmap_analysis pipeline (default engine, no output)
+static double time_heatmap(int cols, long rows, const bench_config *cfg, int work_factor,
+                           int window_height) {
+    double start_time = omp_get_wtime();
+    unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+    padded_int *hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
+    if (max_sums == NULL || hotspots_per_row == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    unsigned long *heatmap = initialize_heatmap(rows, cols, cfg->seed, cfg->lower, cfg->upper);
+    preprocess_heatmap(heatmap, rows, cols, work_factor);
+    analyze_heatmap(heatmap, rows, cols, window_height, PART_A_ROWS, max_sums, hotspots_per_row);
+    free(heatmap);
+    free(hotspots_per_row);
+    free(max_sums);
+    return omp_get_wtime() - start_time;
+}
+
+// heatmap_analysis_quick pipeline: lazy scan, Part A only without a zero row
+static double time_quick(int cols, long rows, const bench_config *cfg, int work_factor,
+                         int window_height) {
+    double start_time = omp_get_wtime();
+    unsigned long *heatmap = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+    padded_int *hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
+    if (heatmap == NULL || hotspots_per_row == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    row_generator gen;
+    row_generator_init(&gen, cols, cfg->seed, cfg->lower, cfg->upper);
+    long long total_hotspots = 0;
+    if (quick_scan(heatmap, rows, cols, &gen, work_factor, hotspots_per_row, &total_hotspots) == -1) {
+        unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+        if (max_sums == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        #pragma omp parallel
+        {
+            window_sums_rows(heatmap, rows, cols, window_height, max_sums);
+        }
+        free(max_sums);
+    }
+    row_generator_free(&gen);
+    free(hotspots_per_row);
+    free(heatmap);
+    return omp_get_wtime() - start_time;
+}
+
+static double time_pi(const bench_config *cfg, int num_threads, double *atomics_per_task) {
+    double start_time = omp_get_wtime();
+    pi_result result;
+    if (run_pi_tasks(cfg->pi_tasks, num_threads, cfg->pi_lower, cfg->pi_upper, cfg->seed, &cfg->pi_opts,
+                     &result) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    double elapsed = omp_get_wtime() - start_time;
+    *atomics_per_task = (double)result.atomic_updates / (result.valid_tasks + 1);
+    pi_result_free(&result);
+    return elapsed;
+}
+
+// Warmups plus cfg->reps timed runs of one configuration
+static void measure(program_kind program, const bench_config *cfg, int num_threads, int cols,
+                    long rows, int work_factor, int window_height, double *samples,
+                    double *atomics_per_task) {
+    omp_set_num_threads(num_threads);
+    for (int r = -cfg->warmup; r < cfg->reps; r++) {
+        double t;
+        if (program == PROGRAM_HEATMAP) {
+            t = time_heatmap(cols, rows, cfg, work_factor, window_height);
+        } else if (program == PROGRAM_QUICK) {
+            t = time_quick(cols, rows, cfg, work_factor, window_height);
+        } else {
+            t = time_pi(cfg, num_threads, atomics_per_task);
+        }
+        if (r >= 0) {
+            samples[r] = t;
+        }
+    }
+}
+
+static void write_record(FILE *out, const bench_record *rec) {
+    fprintf(out, "{\"program\":\"%s\",\"affinity\":\"%s\",\"threads\":%d,\"size\":\"%s\","
+            "\"work_factor\":%d,\"window_height\":%d,\"reps\":%d,\"median\":%.9f,\"mean\":%.9f,"
+            "\"stddev\":%.9f,\"ci95\":%.9f,\"speedup\":%.6f,\"speedup_ci95\":%.6f,\"efficiency\":%.6f,"
+            "\"atomics_per_task\":%.6f}\n",
+            rec->program, rec->affinity, rec->threads, rec->size, rec->work_factor, rec->window_height,
+            rec->reps, rec->median, rec->mean, rec->stddev, rec->ci95, rec->speedup, rec->speedup_ci95,
+            rec->efficiency, rec->atomics_per_task);
+}
+
+// Locate "key": in a record line; returns the start of the value or NULL
+static const char *json_value(const char *line, const char *key) {
+    char pattern[40];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char *p = strstr(line, pattern);
+    return (p == NULL) ? NULL : p + strlen(pattern);
+}
+
+static int json_string(const char *line, const char *key, char *out, size_t size) {
+    const char *p = json_value(line, key);
+    if (p == NULL || *p != '"') {
+        return -1;
+    }
+    p++;
+    size_t n = 0;
+    while (p[n] != '"' && p[n] != '\0' && n + 1 < size) {
+        out[n] = p[n];
+        n++;
+    }
+    out[n] = '\0';
+    return 0;
+}
+
+static double json_number(const char *line, const char *key) {
+    const char *p = json_value(line, key);
+    return (p == NULL) ? 0.0 : strtod(p, NULL);
+}
+
+// Parse a line written by write_record(); returns 0 or -1 for other lines
+static int parse_record(const char *line, bench_record *rec) {
+    memset(rec, 0, sizeof(*rec));
+    if (json_string(line, "program", rec->program, sizeof(rec->program)) != 0 ||
+        json_string(line, "affinity", rec->affinity, sizeof(rec->affinity)) != 0 ||
+        json_string(line, "size", rec->size, sizeof(rec->size)) != 0) {
+        return -1;
+    }
+    rec->threads = (int)json_number(line, "threads");
+    rec->work_factor = (int)json_number(line, "work_factor");
+    rec->window_height = (int)json_number(line, "window_height");
+    rec->reps = (int)json_number(line, "reps");
+    rec->median = json_number(line, "median");
+    rec->mean = json_number(line, "mean");
+    rec->stddev = json_number(line, "stddev");
+    rec->ci95 = json_number(line, "ci95");
+    rec->speedup = json_number(line, "speedup");
+    rec->speedup_ci95 = json_number(line, "speedup_ci95");
+    rec->efficiency = json_number(line, "efficiency");
+    rec->atomics_per_task = json_number(line, "atomics_per_task");
+    return 0;
+}
+
+static int same_config(const bench_record *a, const bench_record *b) {
+    return strcmp(a->program, b->program) == 0 && strcmp(a->affinity, b->affinity) == 0 &&
+           strcmp(a->size, b->size) == 0 && a->threads == b->threads &&
+           a->work_factor == b->work_factor && a->window_height == b->window_height;
+}
+
+static void print_header(FILE *out, const char *program, const char *affinity, const char *size,
+                         int work_factor, int window_height) {
+    if (work_factor > 0) {
+        fprintf(out, "\n%s: size=%s, work_factor=%d, window_height=%d, affinity=%s\n", program, size,
+                work_factor, window_height, affinity);
+        fprintf(out, "Threads | Median (s) | Stddev (s) | 95%% CI (s) | Speedup         | Efficiency\n");
+        fprintf(out, "--------|------------|------------|------------|-----------------|-----------\n");
+    } else {
+        fprintf(out, "\n%s: num_tasks=%s, affinity=%s\n", program, size, affinity);
+        fprintf(out, "Threads | Median (s) | Stddev (s) | 95%% CI (s) | Speedup         | Efficiency | Atomics/task\n");
+        fprintf(out, "--------|------------|------------|------------|-----------------|------------|-------------\n");
+    }
+}
+
+// Thread sweep of one configuration; appends one record per thread count
+static int sweep_threads(program_kind program, const bench_config *cfg, const char *affinity,
+                         int cols, long rows, int work_factor, int window_height, FILE *table,
+                         bench_record *records, int num_records) {
+    double *samples = (double*) malloc(cfg->reps * sizeof(double));
+    if (samples == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    bench_record base;
+    memset(&base, 0, sizeof(base));
+    snprintf(base.program, sizeof(base.program), "%s", program_names[program]);
+    snprintf(base.affinity, sizeof(base.affinity), "%s", affinity);
+    if (program == PROGRAM_PI) {
+        snprintf(base.size, sizeof(base.size), "%d", cfg->pi_tasks);
+    } else {
+        snprintf(base.size, sizeof(base.size), "%dx%ld", cols, rows);
+        base.work_factor = work_factor;
+        base.window_height = window_height;
+    }
+    base.reps = cfg->reps;
+    print_header(table, base.program, affinity, base.size, base.work_factor, base.window_height);
+
+    int first = num_records;
+    for (int k = 0; k < cfg->num_threads && num_records < MAX_RECORDS; k++) {
+        bench_record *rec = &records[num_records++];
+        *rec = base;
+        rec->threads = (int)cfg->threads[k];
+        measure(program, cfg, rec->threads, cols, rows, work_factor, window_height, samples,
+                &rec->atomics_per_task);
+        summarize(samples, cfg->reps, rec);
+
+        // Speedup of medians; the relative CI half-widths of both runs add in quadrature
+        const bench_record *ref = &records[first];
+        rec->speedup = ref->median / rec->median;
+        double rel_ref = ref->ci95 / ref->median;
+        double rel_cur = rec->ci95 / rec->median;
+        rec->speedup_ci95 = rec->speedup * sqrt(rel_ref * rel_ref + rel_cur * rel_cur);
+        rec->efficiency = rec->speedup * ref->threads / rec->threads;
+
+        fprintf(table, "%7d | %10.4f | %10.4f | %10.4f | %6.2f +- %5.2f | %9.1f%%", rec->threads,
+                rec->median, rec->stddev, rec->ci95, rec->speedup, rec->speedup_ci95,
+                rec->efficiency * 100.0);
+        if (program == PROGRAM_PI) {
+            fprintf(table, " | %12.4f", rec->atomics_per_task);
+        }
+        fprintf(table, "\n");
+        fflush(table);
+    }
+
+    free(samples);
+    return num_records;
+}
+
+// Every sweep of the configuration under the current (inherited) affinity
+static int run_sweeps(const bench_config *cfg, const char *affinity, FILE *table,
+                      bench_record *records, int num_records) {
+    for (int p = 0; p < cfg->num_programs; p++) {
+        program_kind program = (program_kind)cfg->programs[p];
+        if (program == PROGRAM_PI) {
+            num_records = sweep_threads(program, cfg, affinity, 0, 0, 0, 0, table, records, num_records);
+            continue;
+        }
+        for (int s = 0; s < cfg->num_sizes; s++) {
+            for (int w = 0; w < cfg->num_works; w++) {
+                for (int h = 0; h < cfg->num_windows; h++) {
+                    if (cfg->windows[h] > cfg->sizes[s][1]) {
+                        continue;
+                    }
+                    num_records = sweep_threads(program, cfg, affinity, cfg->sizes[s][0],
+                                                cfg->sizes[s][1], (int)cfg->works[w],
+                                                (int)cfg->windows[h], table, records, num_records);
+                }
+            }
+        }
+    }
+    return num_records;
+}
+
+// OMP_PLACES/OMP_PROC_BIND are read once at startup, so every affinity other
+// than "none" (inherit the environment) runs in a re-executed copy of this
+// binary. The child prints its table to stderr and its records to the pipe.
+static int run_affinity_child(int argc, char *argv[], const bench_config *cfg, const char *affinity,
+                              bench_record *records, int num_records) {
+    char **child_argv = (char**) malloc((argc + 3) * sizeof(char*));
+    char affinity_arg[48];
+    if (child_argv == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    int n = 0;
+    child_argv[n++] = argv[0];
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--affinity=", 11) != 0 && strncmp(argv[i], "--json=", 7) != 0 &&
+            strncmp(argv[i], "--compare=", 10) != 0) {
+            child_argv[n++] = argv[i];
+        }
+    }
+    snprintf(affinity_arg, sizeof(affinity_arg), "--affinity=%s", affinity);
+    child_argv[n++] = affinity_arg;
+    child_argv[n++] = "--child";
+    child_argv[n] = NULL;
+
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        setenv("OMP_PROC_BIND", affinity, 1);
+        setenv("OMP_PLACES", cfg->places, 1);
+        execv("/proc/self/exe", child_argv);
+        perror("execv");
+        _exit(127);
+    }
+    close(fds[1]);
+    free(child_argv);
+
+    FILE *in = fdopen(fds[0], "r");
+    char line[MAX_LINE];
+    while (in != NULL && fgets(line, sizeof(line), in) != NULL) {
+        if (num_records < MAX_RECORDS && parse_record(line, &records[num_records]) == 0) {
+            num_records++;
+        }
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        fprintf(stderr, "Error: Affinity run %s failed\n", affinity);
+    }
+    return num_records;
+}
+
+// Compare against a baseline file; returns the number of regressions, i.e.
+// configurations whose median moved up by more than both CIs together
+static int compare_baseline(const char *path, const bench_record *records, int num_records) {
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Error: Cannot open %s\n", path);
+        return -1;
+    }
+    bench_record *base = (bench_record*) malloc(MAX_RECORDS * sizeof(bench_record));
+    if (base == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    int num_base = 0;
+    char line[MAX_LINE];
+    while (fgets(line, sizeof(line), in) != NULL && num_base < MAX_RECORDS) {
+        if (parse_record(line, &base[num_base]) == 0) {
+            num_base++;
+        }
+    }
+    fclose(in);
+
+    printf("\nComparison with %s (ratio = current / baseline median):\n", path);
+    printf("Program | Size       | Work | Window | Affinity | Threads | Baseline (s) | Current (s) | Ratio  | Change\n");
+    printf("--------|------------|------|--------|----------|---------|--------------|-------------|--------|-------\n");
+    int regressions = 0;
+    for (int k = 0; k < num_records; k++) {
+        const bench_record *cur = &records[k];
+        const bench_record *old = NULL;
+        for (int b = 0; b < num_base && old == NULL; b++) {
+            if (same_config(cur, &base[b])) {
+                old = &base[b];
+            }
+        }
+        if (old == NULL) {
+            continue;
+        }
+        double diff = cur->median - old->median;
+        double noise = cur->ci95 + old->ci95;
+        const char *change = "same";
+        if (diff > noise) {
+            change = "slower";
+            regressions++;
+        } else if (-diff > noise) {
+            change = "faster";
+        }
+        printf("%-7s | %-10s | %4d | %6d | %-8s | %7d | %12.4f | %11.4f | %6.3f | %s\n", cur->program,
+               cur->size, cur->work_factor, cur->window_height, cur->affinity, cur->threads,
+               old->median, cur->median, cur->median / old->median, change);
+    }
+    free(base);
+    return regressions;
+}
+
+// Comma-separated positive integers; returns the count or -1
+static int parse_list(const char *s, long *out) {
+    int n = 0;
+    while (*s != '\0') {
+        char *end;
+        long v = strtol(s, &end, 10);
+        if (end == s || v <= 0 || n == MAX_LIST) {
+            return -1;
+        }
+        out[n++] = v;
+        s = (*end == ',') ? end + 1 : end;
+        if (*end != ',' && *end != '\0') {
+            return -1;
+        }
+    }
+    return n;
+}
+
+// Comma-separated CxR grid sizes; returns the count or -1
+static int parse_sizes(const char *s, int (*out)[2]) {
+    int n = 0;
+    while (*s != '\0') {
+        int cols, rows, used;
+        if (n == MAX_LIST || sscanf(s, "%dx%d%n", &cols, &rows, &used) != 2 || cols <= 0 || rows <= 0) {
+            return -1;
+        }
+        out[n][0] = cols;
+        out[n][1] = rows;
+        n++;
+        s += used;
+        if (*s == ',') {
+            s++;
+        } else if (*s != '\0') {
+            return -1;
+        }
+    }
+    return n;
+}
+
+static int parse_names(const char *s, char (*out)[16]) {
+    int n = 0;
+    while (*s != '\0') {
+        size_t len = strcspn(s, ",");
+        if (n == MAX_LIST || len == 0 || len >= 16) {
+            return -1;
+        }
+        memcpy(out[n], s, len);
+        out[n][len] = '\0';
+        n++;
+        s += len;
+        if (*s == ',') {
+            s++;
+        }
+    }
+    return n;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  --program=heatmap|quick|pi|all  pipelines to measure (default all)\n");
+    fprintf(stderr, "  --threads=T1,T2,...             thread counts; speedup is relative to the first\n");
+    fprintf(stderr, "                                  (default 1,2,4,... up to the processor count)\n");
+    fprintf(stderr, "  --sizes=CxR,...                 grid sizes (default 2048x2048)\n");
+    fprintf(stderr, "  --work=W1,W2,...                work factors (default 50)\n");
+    fprintf(stderr, "  --windows=H1,H2,...             window heights (default 50)\n");
+    fprintf(stderr, "  --affinity=A1,A2,...            none (inherit), or an OMP_PROC_BIND value such as\n");
+    fprintf(stderr, "                                  close, spread, master (default none)\n");
+    fprintf(stderr, "  --places=P                      OMP_PLACES for the affinity runs (default cores)\n");
+    fprintf(stderr, "  --reps=N                        timed repetitions per configuration (default 5)\n");
+    fprintf(stderr, "  --warmup=N                      untimed runs before them (default 1)\n");
+    fprintf(stderr, "  --seed=S --lower=L --upper=U    heatmap values (default 42, 0, 100)\n");
+    fprintf(stderr, "  --pi-tasks=N --pi-lower=L --pi-upper=U\n");
+    fprintf(stderr, "                                  pi task tree (default 10000, 10000, 1000000)\n");
+    fprintf(stderr, "  --pi-split=N                    split pi tasks above N samples (0: never,\n");
+    fprintf(stderr, "                                  default %d)\n", PI_SPLIT_DEFAULT);
+    fprintf(stderr, "  --pi-budget=blocks|atomic       pi task cap scheme (default blocks)\n");
+    fprintf(stderr, "  --pi-budget-block=N             minimum pool refill (default %d)\n", PI_BUDGET_BLOCK_DEFAULT);
+    fprintf(stderr, "  --pi-reproducible               thread-count independent pi tree and average\n");
+    fprintf(stderr, "  --json=FILE                     write one JSON record per configuration\n");
+    fprintf(stderr, "  --compare=FILE                  compare with a baseline written by --json\n");
+}
+
+int main(int argc, char *argv[]) {
+    bench_config cfg;
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.sizes[0][0] = 2048;
+    cfg.sizes[0][1] = 2048;
+    cfg.num_sizes = 1;
+    cfg.works[0] = 50;
+    cfg.num_works = 1;
+    cfg.windows[0] = 50;
+    cfg.num_windows = 1;
+    strcpy(cfg.affinities[0], "none");
+    cfg.num_affinities = 1;
+    cfg.places = "cores";
+    cfg.reps = 5;
+    cfg.warmup = 1;
+    cfg.seed = 42;
+    cfg.lower = 0;
+    cfg.upper = 100;
+    cfg.pi_tasks = 10000;
+    cfg.pi_lower = 10000;
+    cfg.pi_upper = 1000000;
+    pi_options_init(&cfg.pi_opts);
+    const char *json_path = NULL;
+    const char *compare_path = NULL;
+    const char *program = "all";
+    int child = 0;
+    int valid = 1;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strncmp(arg, "--program=", 10) == 0) {
+            program = arg + 10;
+        } else if (strncmp(arg, "--threads=", 10) == 0) {
+            cfg.num_threads = parse_list(arg + 10, cfg.threads);
+            valid &= (cfg.num_threads > 0);
+        } else if (strncmp(arg, "--sizes=", 8) == 0) {
+            cfg.num_sizes = parse_sizes(arg + 8, cfg.sizes);
+            valid &= (cfg.num_sizes > 0);
+        } else if (strncmp(arg, "--work=", 7) == 0) {
+            cfg.num_works = parse_list(arg + 7, cfg.works);
+            valid &= (cfg.num_works > 0);
+        } else if (strncmp(arg, "--windows=", 10) == 0) {
+            cfg.num_windows = parse_list(arg + 10, cfg.windows);
+            valid &= (cfg.num_windows > 0);
+        } else if (strncmp(arg, "--affinity=", 11) == 0) {
+            cfg.num_affinities = parse_names(arg + 11, cfg.affinities);
+            valid &= (cfg.num_affinities > 0);
+        } else if (strncmp(arg, "--places=", 9) == 0) {
+            cfg.places = arg + 9;
+        } else if (strncmp(arg, "--reps=", 7) == 0) {
+            cfg.reps = atoi(arg + 7);
+        } else if (strncmp(arg, "--warmup=", 9) == 0) {
+            cfg.warmup = atoi(arg + 9);
+        } else if (strncmp(arg, "--seed=", 7) == 0) {
+            cfg.seed = strtoul(arg + 7, NULL, 10);
+        } else if (strncmp(arg, "--lower=", 8) == 0) {
+            cfg.lower = strtoul(arg + 8, NULL, 10);
+        } else if (strncmp(arg, "--upper=", 8) == 0) {
+            cfg.upper = strtoul(arg + 8, NULL, 10);
+        } else if (strncmp(arg, "--pi-tasks=", 11) == 0) {
+            cfg.pi_tasks = atoi(arg + 11);
+        } else if (strncmp(arg, "--pi-lower=", 11) == 0) {
+            cfg.pi_lower = strtoul(arg + 11, NULL, 10);
+        } else if (strncmp(arg, "--pi-upper=", 11) == 0) {
+            cfg.pi_upper = strtoul(arg + 11, NULL, 10);
+        } else if (strncmp(arg, "--pi-split=", 11) == 0) {
+            cfg.pi_opts.split_threshold = strtoul(arg + 11, NULL, 10);
+        } else if (strcmp(arg, "--pi-budget=blocks") == 0) {
+            cfg.pi_opts.budget = PI_BUDGET_BLOCKS;
+        } else if (strcmp(arg, "--pi-budget=atomic") == 0) {
+            cfg.pi_opts.budget = PI_BUDGET_ATOMIC;
+        } else if (strcmp(arg, "--pi-reproducible") == 0) {
+            cfg.pi_opts.reproducible = 1;
+        } else if (strncmp(arg, "--pi-budget-block=", 18) == 0) {
+            cfg.pi_opts.budget_block = atoi(arg + 18);
+        } else if (strncmp(arg, "--json=", 7) == 0) {
+            json_path = arg + 7;
+        } else if (strncmp(arg, "--compare=", 10) == 0) {
+            compare_path = arg + 10;
+        } else if (strcmp(arg, "--child") == 0) {
+            child = 1;
+        } else {
+            valid = 0;
+        }
+    }
+
+    for (int p = 0; p < 3; p++) {
+        if (strcmp(program, "all") == 0 || strcmp(program, program_names[p]) == 0) {
+            cfg.programs[cfg.num_programs++] = p;
+        }
+    }
+    if (cfg.num_threads == 0) {
+        int procs = omp_get_num_procs();
+        for (long t = 1; t < procs; t *= 2) {
+            cfg.threads[cfg.num_threads++] = t;
+        }
+        cfg.threads[cfg.num_threads++] = procs;
+    }
+
+    if (!valid || cfg.num_programs == 0 || cfg.reps <= 0 || cfg.warmup < 0 || cfg.upper <= cfg.lower ||
+        cfg.pi_tasks <= 0 || cfg.pi_upper <= cfg.pi_lower || cfg.pi_opts.budget_block <= 0) {
+        fprintf(stderr, "Error: Invalid parameters\n");
+        usage(argv[0]);
+        return 1;
+    }
+
+    bench_record *records = (bench_record*) malloc(MAX_RECORDS * sizeof(bench_record));
+    if (records == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return 1;
+    }
+    int num_records = 0;
+
+    if (child) {
+        num_records = run_sweeps(&cfg, cfg.affinities[0], stderr, records, 0);
+        for (int k = 0; k < num_records; k++) {
+            write_record(stdout, &records[k]);
+        }
+        free(records);
+        return 0;
+    }
+
+    printf("Speedup benchmark: repetitions=%d, warmup=%d, processors=%d\n", cfg.reps, cfg.warmup,
+           omp_get_num_procs());
+    for (int a = 0; a < cfg.num_affinities; a++) {
+        if (strcmp(cfg.affinities[a], "none") == 0) {
+            num_records = run_sweeps(&cfg, "none", stdout, records, num_records);
+        } else {
+            num_records = run_affinity_child(argc, argv, &cfg, cfg.affinities[a], records, num_records);
+        }
+    }
+
+    int status = 0;
+    if (json_path != NULL) {
+        FILE *out = fopen(json_path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Error: Cannot open %s\n", json_path);
+            status = 1;
+        } else {
+            for (int k = 0; k < num_records; k++) {
+                write_record(out, &records[k]);
+            }
+            fclose(out);
+        }
+    }
+    if (compare_path != NULL) {
+        int regressions = compare_baseline(compare_path, records, num_records);
+        if (regressions != 0) {
+            status = 1;
+        }
+        if (regressions > 0) {
+            printf("\n%d configuration(s) slower than the baseline\n", regressions);
+        }
+    }
+
+    free(records);
+    return status;
+}
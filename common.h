@@ -0,0 +1,72 @@
+#ifndef COMMON_H
+#define COMMON_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+// Helpers shared by the heatmap and pi programs
+
+// Cache line size to prevent false sharing
+#define CACHE_LINE_SIZE 64
+
+// Padded integer to avoid false sharing between threads
+typedef struct {
+    int count;
+    char padding[CACHE_LINE_SIZE - sizeof(int)];
+} padded_int;
+
+// Padded double to avoid false sharing between threads
+typedef struct {
+    double value;
+    char padding[CACHE_LINE_SIZE - sizeof(double)];
+} padded_double;
+
+// malloc() that exits on failure (contents undefined)
+static inline void* malloc_or_die(size_t size) {
+    void *p = malloc(size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+// calloc() that exits on failure (contents zeroed)
+static inline void* calloc_or_die(size_t size) {
+    void *p = calloc(1, size);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+// Hash function
+static inline unsigned long hash(unsigned long x) {
+    x ^= (x >> 21);
+    x *= 2654435761UL;
+    x ^= (x >> 13);
+    x *= 2654435761UL;
+    x ^= (x >> 17);
+    return x;
+}
+
+// Concatenate function
+static inline unsigned concatenate(unsigned x, unsigned y) {
+    unsigned pow = 10;
+    while (y >= pow)
+        pow *= 10;
+    return x * pow + y;
+}
+
+// my_rand function
+static inline unsigned long my_rand(unsigned long* state, unsigned long lower, unsigned long upper) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    unsigned long result = (*state * 0x2545F4914F6CDD1DULL);
+    unsigned long range = (upper > lower) ? (upper - lower) : 0UL;
+    return (range > 0) ? (result % range + lower) : lower;
+}
+
+#endif
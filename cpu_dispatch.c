@@ -0,0 +1,48 @@
+#include <cpuid.h>
+#include "cpu_dispatch.h"
+
+// Read the extended control register (which register states the OS saves)
+static unsigned long long read_xcr0(void) {
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+
+cpu_isa cpu_detect_isa(void) {
+    // Cached after the first call; kernels query it from inside parallel regions
+    static int detected = -1;
+    int cached = __atomic_load_n(&detected, __ATOMIC_RELAXED);
+    if (cached >= 0) {
+        return (cpu_isa)cached;
+    }
+    
+    unsigned int eax, ebx, ecx, edx;
+    int isa = ISA_SCALAR;
+    
+    if (__get_cpuid(1, &eax, &ebx, &ecx, &edx) && (ecx & bit_OSXSAVE)) {
+        unsigned long long xcr0 = read_xcr0();
+        int ymm_enabled = (xcr0 & 0x6) == 0x6;      // SSE + AVX state
+        int zmm_enabled = (xcr0 & 0xe6) == 0xe6;    // + opmask and ZMM state
+        int has_fma = (ecx & bit_FMA) != 0;
+        
+        if (__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+            if (ymm_enabled && has_fma && (ebx & bit_AVX2)) {
+                isa = ISA_AVX2;
+            }
+            if (zmm_enabled && isa == ISA_AVX2 && (ebx & bit_AVX512F) && (ebx & bit_AVX512DQ)) {
+                isa = ISA_AVX512;
+            }
+        }
+    }
+    
+    __atomic_store_n(&detected, isa, __ATOMIC_RELAXED);
+    return (cpu_isa)isa;
+}
+
+const char* cpu_isa_name(cpu_isa isa) {
+    switch (isa) {
+        case ISA_AVX512: return "avx512";
+        case ISA_AVX2:   return "avx2";
+        default:         return "scalar";
+    }
+}
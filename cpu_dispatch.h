@@ -0,0 +1,17 @@
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+// Instruction set levels used for runtime kernel dispatch
+typedef enum {
+    ISA_SCALAR,
+    ISA_AVX2,     // AVX2 (+ FMA)
+    ISA_AVX512    // AVX-512 F + DQ
+} cpu_isa;
+
+// Highest ISA level supported by both the CPU (CPUID) and the OS (XCR0)
+cpu_isa cpu_detect_isa(void);
+
+// Printable name of an ISA level
+const char* cpu_isa_name(cpu_isa isa);
+
+#endif
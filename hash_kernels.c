@@ -0,0 +1,330 @@
+#include <string.h>
+#include <immintrin.h>
+#include "common.h"
+#include "cpu_dispatch.h"
+#include "hash_kernels.h"
+
+// Independent chains interleaved by the scalar ILP variant
+#define HASH_ILP_CHAINS 4
+
+// Vectors kept in flight by the SIMD variants
+#define HASH_SIMD_UNROLL 4
+
+// Multiplier of hash(); fits in 32 bits, which the AVX2 emulation relies on
+#define HASH_MULTIPLIER 2654435761UL
+
+static hash_variant selected = HASH_AUTO;
+
+void hash_row_scalar(unsigned long *values, size_t n, int work_factor) {
+    for (size_t i = 0; i < n; i++) {
+        unsigned long val = values[i];
+        for (int w = 0; w < work_factor; w++) {
+            val = hash(val);
+        }
+        values[i] = val;
+    }
+}
+
+// Runs HASH_ILP_CHAINS independent multiply/xorshift chains side by side so
+// the core can overlap their latencies
+void hash_row_ilp(unsigned long *values, size_t n, int work_factor) {
+    size_t i = 0;
+    for (; i + HASH_ILP_CHAINS <= n; i += HASH_ILP_CHAINS) {
+        unsigned long v0 = values[i];
+        unsigned long v1 = values[i + 1];
+        unsigned long v2 = values[i + 2];
+        unsigned long v3 = values[i + 3];
+        for (int w = 0; w < work_factor; w++) {
+            v0 = hash(v0);
+            v1 = hash(v1);
+            v2 = hash(v2);
+            v3 = hash(v3);
+        }
+        values[i] = v0;
+        values[i + 1] = v1;
+        values[i + 2] = v2;
+        values[i + 3] = v3;
+    }
+    hash_row_scalar(values + i, n - i, work_factor);
+}
+
+// 64 x 32-bit multiply modulo 2^64 from two 32 x 32 -> 64 products:
+// x * m = lo(x) * m + ((hi(x) * m) << 32)
+__attribute__((target("avx2")))
+static inline __m256i mul_u64_u32_avx2(__m256i x, __m256i m) {
+    __m256i lo = _mm256_mul_epu32(x, m);
+    __m256i hi = _mm256_mul_epu32(_mm256_srli_epi64(x, 32), m);
+    return _mm256_add_epi64(lo, _mm256_slli_epi64(hi, 32));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i hash_avx2(__m256i x, __m256i m) {
+    x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 21));
+    x = mul_u64_u32_avx2(x, m);
+    x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 13));
+    x = mul_u64_u32_avx2(x, m);
+    x = _mm256_xor_si256(x, _mm256_srli_epi64(x, 17));
+    return x;
+}
+
+__attribute__((target("avx2")))
+void hash_row_avx2(unsigned long *values, size_t n, int work_factor) {
+    const __m256i m = _mm256_set1_epi64x(HASH_MULTIPLIER);
+    size_t i = 0;
+    
+    for (; i + 4 * HASH_SIMD_UNROLL <= n; i += 4 * HASH_SIMD_UNROLL) {
+        __m256i v0 = _mm256_loadu_si256((const __m256i*)(values + i));
+        __m256i v1 = _mm256_loadu_si256((const __m256i*)(values + i + 4));
+        __m256i v2 = _mm256_loadu_si256((const __m256i*)(values + i + 8));
+        __m256i v3 = _mm256_loadu_si256((const __m256i*)(values + i + 12));
+        for (int w = 0; w < work_factor; w++) {
+            v0 = hash_avx2(v0, m);
+            v1 = hash_avx2(v1, m);
+            v2 = hash_avx2(v2, m);
+            v3 = hash_avx2(v3, m);
+        }
+        _mm256_storeu_si256((__m256i*)(values + i), v0);
+        _mm256_storeu_si256((__m256i*)(values + i + 4), v1);
+        _mm256_storeu_si256((__m256i*)(values + i + 8), v2);
+        _mm256_storeu_si256((__m256i*)(values + i + 12), v3);
+    }
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(values + i));
+        for (int w = 0; w < work_factor; w++) {
+            v = hash_avx2(v, m);
+        }
+        _mm256_storeu_si256((__m256i*)(values + i), v);
+    }
+    hash_row_ilp(values + i, n - i, work_factor);
+}
+
+__attribute__((target("avx512f,avx512dq")))
+static inline __m512i hash_avx512(__m512i x, __m512i m) {
+    x = _mm512_xor_si512(x, _mm512_srli_epi64(x, 21));
+    x = _mm512_mullo_epi64(x, m);
+    x = _mm512_xor_si512(x, _mm512_srli_epi64(x, 13));
+    x = _mm512_mullo_epi64(x, m);
+    x = _mm512_xor_si512(x, _mm512_srli_epi64(x, 17));
+    return x;
+}
+
+__attribute__((target("avx512f,avx512dq")))
+void hash_row_avx512(unsigned long *values, size_t n, int work_factor) {
+    const __m512i m = _mm512_set1_epi64(HASH_MULTIPLIER);
+    size_t i = 0;
+    
+    for (; i + 8 * HASH_SIMD_UNROLL <= n; i += 8 * HASH_SIMD_UNROLL) {
+        __m512i v0 = _mm512_loadu_si512(values + i);
+        __m512i v1 = _mm512_loadu_si512(values + i + 8);
+        __m512i v2 = _mm512_loadu_si512(values + i + 16);
+        __m512i v3 = _mm512_loadu_si512(values + i + 24);
+        for (int w = 0; w < work_factor; w++) {
+            v0 = hash_avx512(v0, m);
+            v1 = hash_avx512(v1, m);
+            v2 = hash_avx512(v2, m);
+            v3 = hash_avx512(v3, m);
+        }
+        _mm512_storeu_si512(values + i, v0);
+        _mm512_storeu_si512(values + i + 8, v1);
+        _mm512_storeu_si512(values + i + 16, v2);
+        _mm512_storeu_si512(values + i + 24, v3);
+    }
+    // Remaining cells with a masked vector
+    for (; i < n; i += 8) {
+        __mmask8 mask = (n - i >= 8) ? 0xff : (__mmask8)((1u << (n - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi64(mask, values + i);
+        for (int w = 0; w < work_factor; w++) {
+            v = hash_avx512(v, m);
+        }
+        _mm512_mask_storeu_epi64(values + i, mask, v);
+    }
+}
+
+// Kernels specialized at compile time for the work factors in
+// HASH_FIXED_FACTORS: the round count is a constant, so the chains are
+// fully unrolled (in groups of 10 rounds) and HASH_FIXED_CHAINS
+// cells or vectors are interleaved to keep the multipliers busy
+#define HASH_FIXED_CHAINS 8
+#define HASH_FIXED_UNROLL _Pragma("GCC unroll 10")
+
+static inline __attribute__((always_inline))
+void hash_fixed_ilp(unsigned long *values, size_t n, const int rounds) {
+    size_t i = 0;
+    for (; i + HASH_FIXED_CHAINS <= n; i += HASH_FIXED_CHAINS) {
+        unsigned long v[HASH_FIXED_CHAINS];
+        for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+            v[c] = values[i + c];
+        }
+        HASH_FIXED_UNROLL
+        for (int w = 0; w < rounds; w++) {
+            for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+                v[c] = hash(v[c]);
+            }
+        }
+        for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+            values[i + c] = v[c];
+        }
+    }
+    for (; i < n; i++) {
+        unsigned long val = values[i];
+        HASH_FIXED_UNROLL
+        for (int w = 0; w < rounds; w++) {
+            val = hash(val);
+        }
+        values[i] = val;
+    }
+}
+
+__attribute__((target("avx2"))) static inline __attribute__((always_inline))
+void hash_fixed_avx2(unsigned long *values, size_t n, const int rounds) {
+    const __m256i m = _mm256_set1_epi64x(HASH_MULTIPLIER);
+    size_t i = 0;
+    for (; i + 4 * HASH_FIXED_CHAINS <= n; i += 4 * HASH_FIXED_CHAINS) {
+        __m256i v[HASH_FIXED_CHAINS];
+        for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+            v[c] = _mm256_loadu_si256((const __m256i*)(values + i + 4 * c));
+        }
+        HASH_FIXED_UNROLL
+        for (int w = 0; w < rounds; w++) {
+            for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+                v[c] = hash_avx2(v[c], m);
+            }
+        }
+        for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+            _mm256_storeu_si256((__m256i*)(values + i + 4 * c), v[c]);
+        }
+    }
+    hash_fixed_ilp(values + i, n - i, rounds);
+}
+
+__attribute__((target("avx512f,avx512dq"))) static inline __attribute__((always_inline))
+void hash_fixed_avx512(unsigned long *values, size_t n, const int rounds) {
+    const __m512i m = _mm512_set1_epi64(HASH_MULTIPLIER);
+    size_t i = 0;
+    for (; i + 8 * HASH_FIXED_CHAINS <= n; i += 8 * HASH_FIXED_CHAINS) {
+        __m512i v[HASH_FIXED_CHAINS];
+        for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+            v[c] = _mm512_loadu_si512(values + i + 8 * c);
+        }
+        HASH_FIXED_UNROLL
+        for (int w = 0; w < rounds; w++) {
+            for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+                v[c] = hash_avx512(v[c], m);
+            }
+        }
+        for (int c = 0; c < HASH_FIXED_CHAINS; c++) {
+            _mm512_storeu_si512(values + i + 8 * c, v[c]);
+        }
+    }
+    for (; i < n; i += 8) {
+        __mmask8 mask = (n - i >= 8) ? 0xff : (__mmask8)((1u << (n - i)) - 1);
+        __m512i v = _mm512_maskz_loadu_epi64(mask, values + i);
+        HASH_FIXED_UNROLL
+        for (int w = 0; w < rounds; w++) {
+            v = hash_avx512(v, m);
+        }
+        _mm512_mask_storeu_epi64(values + i, mask, v);
+    }
+}
+
+// One specialized kernel per variant and factor
+#define DEFINE_FIXED_KERNELS(W) \
+    static void hash_row_ilp_w##W(unsigned long *values, size_t n, int work_factor) { \
+        (void)work_factor; \
+        hash_fixed_ilp(values, n, W); \
+    } \
+    __attribute__((target("avx2"))) \
+    static void hash_row_avx2_w##W(unsigned long *values, size_t n, int work_factor) { \
+        (void)work_factor; \
+        hash_fixed_avx2(values, n, W); \
+    } \
+    __attribute__((target("avx512f,avx512dq"))) \
+    static void hash_row_avx512_w##W(unsigned long *values, size_t n, int work_factor) { \
+        (void)work_factor; \
+        hash_fixed_avx512(values, n, W); \
+    }
+
+HASH_FIXED_FACTORS(DEFINE_FIXED_KERNELS)
+
+#define FIXED_FACTOR(W) W,
+#define FIXED_ILP(W) hash_row_ilp_w##W,
+#define FIXED_AVX2(W) hash_row_avx2_w##W,
+#define FIXED_AVX512(W) hash_row_avx512_w##W,
+
+static const int fixed_factors[] = { HASH_FIXED_FACTORS(FIXED_FACTOR) };
+
+#define NUM_FIXED_FACTORS (int)(sizeof(fixed_factors) / sizeof(fixed_factors[0]))
+
+// Dispatch table; variants without specializations fall back to the generic loop
+static const hash_row_fn fixed_kernels[HASH_AVX512 + 1][NUM_FIXED_FACTORS] = {
+    [HASH_ILP] = { HASH_FIXED_FACTORS(FIXED_ILP) },
+    [HASH_AVX2] = { HASH_FIXED_FACTORS(FIXED_AVX2) },
+    [HASH_AVX512] = { HASH_FIXED_FACTORS(FIXED_AVX512) }
+};
+
+static const hash_row_fn generic_kernels[HASH_AVX512 + 1] = {
+    [HASH_SCALAR] = hash_row_scalar,
+    [HASH_ILP] = hash_row_ilp,
+    [HASH_AVX2] = hash_row_avx2,
+    [HASH_AVX512] = hash_row_avx512
+};
+
+hash_row_fn hash_kernel_generic(hash_variant variant) {
+    return generic_kernels[(variant == HASH_AUTO) ? hash_selected() : variant];
+}
+
+hash_row_fn hash_kernel(hash_variant variant, int work_factor) {
+    if (variant == HASH_AUTO) {
+        variant = hash_selected();
+    }
+    for (int k = 0; k < NUM_FIXED_FACTORS; k++) {
+        if (fixed_factors[k] == work_factor && fixed_kernels[variant][k] != NULL) {
+            return fixed_kernels[variant][k];
+        }
+    }
+    return generic_kernels[variant];
+}
+
+int hash_select(hash_variant variant) {
+    cpu_isa isa = cpu_detect_isa();
+    
+    if (variant == HASH_AUTO) {
+        variant = (isa == ISA_AVX512) ? HASH_AVX512 : (isa == ISA_AVX2) ? HASH_AVX2 : HASH_ILP;
+    }
+    if ((variant == HASH_AVX2 && isa < ISA_AVX2) || (variant == HASH_AVX512 && isa < ISA_AVX512)) {
+        return -1;
+    }
+    
+    selected = variant;
+    return 0;
+}
+
+hash_variant hash_selected(void) {
+    if (selected == HASH_AUTO) {
+        hash_select(HASH_AUTO);
+    }
+    return selected;
+}
+
+int hash_parse_variant(const char *name) {
+    for (int v = HASH_AUTO; v <= HASH_AVX512; v++) {
+        if (strcmp(name, hash_variant_name((hash_variant)v)) == 0) {
+            return v;
+        }
+    }
+    return -1;
+}
+
+const char* hash_variant_name(hash_variant variant) {
+    switch (variant) {
+        case HASH_SCALAR: return "scalar";
+        case HASH_ILP:    return "ilp";
+        case HASH_AVX2:   return "avx2";
+        case HASH_AVX512: return "avx512";
+        default:          return "auto";
+    }
+}
+
+void hash_row(unsigned long *values, size_t n, int work_factor) {
+    hash_kernel(HASH_AUTO, work_factor)(values, n, work_factor);
+}
@@ -0,0 +1,50 @@
+#ifndef HASH_KERNELS_H
+#define HASH_KERNELS_H
+
+#include <stddef.h>
+
+// Applies hash() work_factor times to each of the n values in place
+typedef void (*hash_row_fn)(unsigned long *values, size_t n, int work_factor);
+
+// Preprocess engine variants
+typedef enum {
+    HASH_AUTO,     // best variant the CPU supports
+    HASH_SCALAR,   // one dependency chain at a time (reference)
+    HASH_ILP,      // several interleaved scalar chains
+    HASH_AVX2,     // 4 lanes per vector, emulated 64-bit multiply
+    HASH_AVX512    // 8 lanes per vector, native 64-bit multiply
+} hash_variant;
+
+// Select the variant used by hash_row(); returns -1 if the CPU lacks it.
+// HASH_AUTO resolves via CPUID.
+int hash_select(hash_variant variant);
+
+// Currently selected variant (resolved, never HASH_AUTO)
+hash_variant hash_selected(void);
+
+// Parse a variant name (auto, scalar, ilp, avx2, avx512); returns -1 if unknown
+int hash_parse_variant(const char *name);
+
+// Printable name of a variant
+const char* hash_variant_name(hash_variant variant);
+
+// Work factors with compile-time specialized kernels (X-macro list)
+#define HASH_FIXED_FACTORS(X) X(1) X(10) X(50) X(100)
+
+// Kernel for a variant (HASH_AUTO: the selected one) and work factor: the
+// specialized kernel when there is one, the generic loop otherwise
+hash_row_fn hash_kernel(hash_variant variant, int work_factor);
+
+// Generic (runtime work factor) kernel of a variant
+hash_row_fn hash_kernel_generic(hash_variant variant);
+
+// Hash n values in place with the selected variant
+void hash_row(unsigned long *values, size_t n, int work_factor);
+
+// Individual variants (the SIMD ones require the matching CPU support)
+void hash_row_scalar(unsigned long *values, size_t n, int work_factor);
+void hash_row_ilp(unsigned long *values, size_t n, int work_factor);
+void hash_row_avx2(unsigned long *values, size_t n, int work_factor);
+void hash_row_avx512(unsigned long *values, size_t n, int work_factor);
+
+#endif
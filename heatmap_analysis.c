@@ -1,92 +1,306 @@
 #include <stdio.h>
+#include <limits.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 #include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_incremental.h"
+#include "heatmap_io.h"
+#include "heatmap_kernels.h"
+#include "heatmap_numa.h"
+#include "heatmap_stream.h"
+#include "heatmap_tasks.h"
+#include "hotspot_list.h"
+#include "phase_profile.h"
+#include "rect_sums.h"
+#include "text_output.h"
+#include "tuning.h"
+#include "window_prefix.h"
 
-// Cache line size to prevent false sharing
-#define CACHE_LINE_SIZE 64
-
-// Padded integer to avoid false sharing between threads
-typedef struct {
-    int count;
-    char padding[CACHE_LINE_SIZE - sizeof(int)];
-} padded_int;
-
-// Hash function
-unsigned long hash(unsigned long x) {
-    x ^= (x >> 21);
-    x *= 2654435761UL;
-    x ^= (x >> 13);
-    x *= 2654435761UL;
-    x ^= (x >> 17);
-    return x;
-}
-
-// Concatenate function
-unsigned concatenate(unsigned x, unsigned y) {
-    unsigned pow = 10;
-    while (y >= pow)
-        pow *= 10;
-    return x * pow + y;
-}
-
-// my_rand function
-unsigned long my_rand(unsigned long* state, unsigned long lower, unsigned long upper) {
-    *state ^= *state >> 12;
-    *state ^= *state << 25;
-    *state ^= *state >> 27;
-    unsigned long result = (*state * 0x2545F4914F6CDD1DULL);
-    unsigned long range = (upper > lower) ? (upper - lower) : 0UL;
-    return (range > 0) ? (result % range + lower) : lower;
+// Binary alternative to a verbose section: write it as PREFIX.name.heatmap
+// and print where it went. Returns 0 on success, -1 after an error.
+int dump_section(const char *prefix, const char *name, const unsigned long *data,
+                 long rows, int cols, int work_factor) {
+    size_t len = strlen(prefix) + strlen(name) + 10;
+    char *path = (char*) malloc(len);
+    if (path == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    snprintf(path, len, "%s.%s.heatmap", prefix, name);
+    int status = heatmap_file_write(path, data, rows, cols, work_factor);
+    if (status == 0) {
+        printf("%s written to %s\n\n", name, path);
+    }
+    free(path);
+    return status;
 }
 
-// Initialize heatmap with random values
-unsigned long* initialize_heatmap(int rows, int cols, unsigned long seed, unsigned long lower, unsigned long upper) {
-    // Allocate flat 1D array to represent 2D matrix
-    unsigned long *heatmap = (unsigned long*) malloc(rows * cols * sizeof(unsigned long));
-    
-    if (heatmap == NULL) {
+// Fused single-pass pipeline: the grid is processed in L2-sized row bands.
+// Each band is generated, hashed, checked for hotspots (rows whose lower
+// neighbor is already available, i.e. a one-row halo into the next band)
+// and fed into the running column window sums before the next band starts.
+// Produces exactly the same results as the multi-pass path.
+void fused_analysis(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                    unsigned long lower, unsigned long upper, int work_factor,
+                    int window_height, int verbose, unsigned long long *max_sums,
+                    padded_int *hotspots_per_row, long long *total_hotspots) {
+    unsigned long long *cur_sums = (unsigned long long*) calloc(cols, sizeof(unsigned long long));
+    if (cur_sums == NULL) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         exit(1);
     }
     
-    // Fill the array with random values in range [lower, upper)
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            unsigned long s = seed * concatenate(i, j);
-            heatmap[i * cols + j] = my_rand(&s, lower, upper);
+    int band_rows = band_rows_for_cache(cols, omp_get_max_threads());
+    hash_selected();
+    int col_block = column_block_size(cols, omp_get_max_threads());
+    int num_col_blocks = (cols + col_block - 1) / col_block;
+    long long total = 0;
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    
+    if (verbose) {
+        printf("A:\n");
+    }
+    
+    #pragma omp parallel
+    {
+        for (long band_start = 0; band_start < rows; band_start += band_rows) {
+            long band_end = (band_start + band_rows < rows) ? band_start + band_rows : rows;
+            
+            // Generate the band (hashing right away unless the raw values are printed)
+            profile_enter(PROF_INIT);
+            #pragma omp for schedule(runtime) nowait
+            for (long i = band_start; i < band_end; i++) {
+                generate_row(&gen, &heatmap[(size_t)i * cols], i);
+                if (!verbose) {
+                    hash_row(&heatmap[(size_t)i * cols], cols, work_factor);
+                }
+            }
+            profile_leave(PROF_INIT);
+            #pragma omp barrier
+            
+            if (verbose) {
+                team_write_grid_rows(heatmap, band_start, band_end, cols);
+                
+                profile_enter(PROF_PREPROCESS);
+                #pragma omp for schedule(runtime) nowait
+                for (long i = band_start; i < band_end; i++) {
+                    hash_row(&heatmap[(size_t)i * cols], cols, work_factor);
+                }
+                profile_leave(PROF_PREPROCESS);
+                #pragma omp barrier
+            }
+            
+            // Part B: the last row of the band waits for the next band's first row
+            long hot_begin = (band_start > 0) ? band_start - 1 : 0;
+            long hot_end = (band_end == rows) ? rows : band_end - 1;
+            profile_enter(PROF_PART_B);
+            #pragma omp for schedule(runtime) reduction(+:total) nowait
+            for (long i = hot_begin; i < hot_end; i++) {
+                int row_hotspots = count_row_hotspots(heatmap, rows, cols, i);
+                hotspots_per_row[i].count = row_hotspots;
+                total += row_hotspots;
+            }
+            profile_leave(PROF_PART_B);
+            
+            // Part A: advance the running window sums of a column block through the band
+            // (the barrier protects the band before the next one is generated)
+            profile_enter(PROF_PART_A);
+            #pragma omp for schedule(runtime) nowait
+            for (int cb = 0; cb < num_col_blocks; cb++) {
+                int col_start = cb * col_block;
+                int col_end = (col_start + col_block < cols) ? col_start + col_block : cols;
+                window_sums_block(heatmap, cols, band_start, band_end, window_height, col_start, col_end,
+                                  &cur_sums[col_start], &max_sums[col_start]);
+            }
+            profile_leave(PROF_PART_A);
+            #pragma omp barrier
         }
     }
     
-    return heatmap;
+    if (verbose) {
+        printf("\n");
+    }
+    
+    *total_hotspots = total;
+    row_generator_free(&gen);
+    free(cur_sums);
 }
 
-// Pre-process heatmap by applying hash function work_factor times
-void preprocess_heatmap(unsigned long *heatmap, int rows, int cols, int work_factor) {
-    // Apply hash function work_factor times to each element
-    #pragma omp parallel for collapse(2) schedule(static)
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            unsigned long val = heatmap[i * cols + j];
-            for (int w = 0; w < work_factor; w++) {
-                val = hash(val);
-            }
-            heatmap[i * cols + j] = val;
+// One silent run of the selected engine, timed by the autotuner
+typedef struct {
+    const char *engine;
+    long rows;
+    int cols;
+    unsigned long seed;
+    unsigned long lower;
+    unsigned long upper;
+    int window_height;
+    int work_factor;
+    part_a_kernel part_a;
+} engine_run;
+
+double time_engine(void *ctx) {
+    const engine_run *run = (const engine_run*)ctx;
+    long rows = run->rows;
+    int cols = run->cols;
+    long long total_hotspots = 0;
+    double start_time = omp_get_wtime();
+    unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+    padded_int *hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
+    if (max_sums == NULL || hotspots_per_row == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    if (strcmp(run->engine, "stream") == 0) {
+        stream_analysis(rows, cols, run->seed, run->lower, run->upper, run->window_height,
+                        run->work_factor, 0, max_sums, NULL, &total_hotspots);
+    } else if (strcmp(run->engine, "fused") == 0) {
+        unsigned long *heatmap = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+        if (heatmap == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
         }
+        fused_analysis(heatmap, rows, cols, run->seed, run->lower, run->upper, run->work_factor,
+                       run->window_height, 0, max_sums, hotspots_per_row, &total_hotspots);
+        free(heatmap);
+    } else {
+        unsigned long *heatmap = initialize_heatmap(rows, cols, run->seed, run->lower, run->upper);
+        preprocess_heatmap(heatmap, rows, cols, run->work_factor);
+        analyze_heatmap(heatmap, rows, cols, run->window_height, run->part_a, max_sums, hotspots_per_row);
+        free(heatmap);
     }
+    free(hotspots_per_row);
+    free(max_sums);
+    return omp_get_wtime() - start_time;
+}
+
+void print_usage(const char *prog) {
+    fprintf(stderr, "Usage: %s <columns> <rows> <seed> <lower> <upper> <window_height> <verbose> <num_threads> <work_factor> [options]\n", prog);
+    fprintf(stderr, "Options:\n");
+    fprintf(stderr, "  --fused                      single pass over L2-sized row bands\n");
+    fprintf(stderr, "  --tasks                      task graph over row bands (depend clauses, no\n");
+    fprintf(stderr, "                               global barriers); phase timing on stderr\n");
+    fprintf(stderr, "  --stream                     out-of-core mode, memory independent of rows\n");
+    fprintf(stderr, "  --numa                       per-node row partitions (mbind) owned by the same\n");
+    fprintf(stderr, "                               threads in every phase; locality report on stderr\n");
+    fprintf(stderr, "  --partA=rows|columns         Part A kernel (default rows)\n");
+    fprintf(stderr, "  --hash=auto|scalar|ilp|avx2|avx512\n");
+    fprintf(stderr, "                               preprocess engine (default auto)\n");
+    fprintf(stderr, "  --load=FILE                  analyze a binary heatmap file instead of\n");
+    fprintf(stderr, "                               generating one (columns/rows/seed/lower/upper\n");
+    fprintf(stderr, "                               are taken from or ignored for the file)\n");
+    fprintf(stderr, "  --windows=H1,H2,...          Part A for every listed window height from one\n");
+    fprintf(stderr, "                               prefix-sum pass (replaces <window_height>)\n");
+    fprintf(stderr, "  --rects=HxW,...              maximum-sum HxW rectangles (summed-area table)\n");
+    fprintf(stderr, "  --hotspots=FILE              write every hotspot as a \"row,col,value\" line\n");
+    fprintf(stderr, "  --topk=K                     print the K hottest hotspots\n");
+    fprintf(stderr, "  --updates=FILE               apply batches of \"row col value\" cell updates\n");
+    fprintf(stderr, "                               incrementally after the initial analysis\n");
+    fprintf(stderr, "  --dump=PREFIX                write the verbose grid, max sums and hotspot\n");
+    fprintf(stderr, "                               counts as binary heatmap files instead of text\n");
+    fprintf(stderr, "  --save=FILE                  write the preprocessed grid as a binary heatmap file\n");
+    fprintf(stderr, "  --autotune[=REPS]            search schedule, chunk, block/band sizes and thread\n");
+    fprintf(stderr, "                               placement for this engine and shape (best of REPS\n");
+    fprintf(stderr, "                               runs each, default 3) and store the winner in the\n");
+    fprintf(stderr, "                               tuning profile; later runs load it automatically\n");
 }
 
 int main(int argc, char *argv[]) {
     // Check command-line arguments
-    if (argc != 10) {
-        fprintf(stderr, "Usage: %s <columns> <rows> <seed> <lower> <upper> <window_height> <verbose> <num_threads> <work_factor>\n", argv[0]);
+    if (argc < 10) {
+        print_usage(argv[0]);
         return 1;
     }
     
+    // Optional switches after the positional arguments
+    int fused = 0;
+    int stream = 0;
+    int tasks = 0;
+    int numa = 0;
+    const char *load_path = NULL;
+    const char *save_path = NULL;
+    int *heights = NULL;
+    int num_heights = 0;
+    rect_shape *shapes = NULL;
+    int num_shapes = 0;
+    const char *hotspots_path = NULL;
+    int top_k = 0;
+    const char *updates_path = NULL;
+    const char *dump_prefix = NULL;
+    part_a_kernel part_a = PART_A_ROWS;
+    int autotune_reps = 0;
+    for (int a = 10; a < argc; a++) {
+        if (strcmp(argv[a], "--fused") == 0) {
+            fused = 1;
+        } else if (strcmp(argv[a], "--tasks") == 0) {
+            tasks = 1;
+        } else if (strcmp(argv[a], "--stream") == 0) {
+            stream = 1;
+        } else if (strcmp(argv[a], "--numa") == 0) {
+            numa = 1;
+        } else if (strcmp(argv[a], "--partA=rows") == 0) {
+            part_a = PART_A_ROWS;
+        } else if (strcmp(argv[a], "--partA=columns") == 0) {
+            part_a = PART_A_COLUMNS;
+        } else if (strncmp(argv[a], "--load=", 7) == 0) {
+            load_path = argv[a] + 7;
+        } else if (strncmp(argv[a], "--save=", 7) == 0) {
+            save_path = argv[a] + 7;
+        } else if (strncmp(argv[a], "--windows=", 10) == 0) {
+            free(heights);
+            num_heights = parse_window_heights(argv[a] + 10, &heights);
+            if (num_heights < 0) {
+                fprintf(stderr, "Error: Invalid window height list %s\n", argv[a] + 10);
+                return 1;
+            }
+        } else if (strncmp(argv[a], "--rects=", 8) == 0) {
+            free(shapes);
+            num_shapes = parse_rect_shapes(argv[a] + 8, &shapes);
+            if (num_shapes < 0) {
+                fprintf(stderr, "Error: Invalid rectangle list %s\n", argv[a] + 8);
+                return 1;
+            }
+        } else if (strncmp(argv[a], "--hotspots=", 11) == 0) {
+            hotspots_path = argv[a] + 11;
+        } else if (strncmp(argv[a], "--dump=", 7) == 0) {
+            dump_prefix = argv[a] + 7;
+        } else if (strncmp(argv[a], "--updates=", 10) == 0) {
+            updates_path = argv[a] + 10;
+        } else if (strncmp(argv[a], "--topk=", 7) == 0) {
+            char *end;
+            long k = strtol(argv[a] + 7, &end, 10);
+            if (*end != '\0' || k <= 0 || k > INT_MAX) {
+                fprintf(stderr, "Error: Invalid top-k count %s\n", argv[a] + 7);
+                return 1;
+            }
+            top_k = (int)k;
+        } else if (strcmp(argv[a], "--autotune") == 0) {
+            autotune_reps = 3;
+        } else if (strncmp(argv[a], "--autotune=", 11) == 0) {
+            autotune_reps = atoi(argv[a] + 11);
+            if (autotune_reps <= 0) {
+                fprintf(stderr, "Error: Invalid autotune repetitions %s\n", argv[a] + 11);
+                return 1;
+            }
+        } else if (strncmp(argv[a], "--hash=", 7) == 0) {
+            int variant = hash_parse_variant(argv[a] + 7);
+            if (variant < 0 || hash_select((hash_variant)variant) != 0) {
+                fprintf(stderr, "Error: Hash variant %s is not available\n", argv[a] + 7);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[a]);
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
     
     // Parse command-line arguments
     int cols = atoi(argv[1]);
-    int rows = atoi(argv[2]);
+    long rows = strtol(argv[2], NULL, 10);
     unsigned long seed = strtoul(argv[3], NULL, 10);  
     unsigned long lower = strtoul(argv[4], NULL, 10); 
     unsigned long upper = strtoul(argv[5], NULL, 10); 
@@ -97,136 +311,314 @@ int main(int argc, char *argv[]) {
     
     // Set number of OpenMP threads
     omp_set_num_threads(num_threads);
+    profile_init("heatmap_analysis");
+    
+    // A loaded grid replaces the generated one; its shape comes from the file
+    heatmap_file loaded;
+    if (load_path != NULL) {
+        if (fused || stream || tasks || numa || heatmap_file_open(load_path, 1, &loaded) != 0) {
+            fprintf(stderr, "Error: Invalid parameters\n");
+            return 1;
+        }
+        rows = loaded.rows;
+        cols = loaded.cols;
+        if (loaded.work_factor > work_factor) {
+            fprintf(stderr, "Error: %s is already hashed %d times (work_factor=%d)\n",
+                    load_path, loaded.work_factor, work_factor);
+            return 1;
+        }
+    }
     
     // Validate input
-    if (rows <= 0 || cols <= 0 || window_height <= 0 || window_height > rows || upper <= lower) {
+    if (rows <= 0 || cols <= 0 || window_height <= 0 || window_height > rows ||
+        (upper <= lower && load_path == NULL) || (fused + stream + tasks + numa > 1) || ((stream || numa) && save_path != NULL) ||
+        ((num_heights > 0 || num_shapes > 0 || hotspots_path != NULL || top_k > 0 ||
+          updates_path != NULL || dump_prefix != NULL) && (fused || stream || tasks || numa)) ||
+        (autotune_reps > 0 && (tasks || numa || load_path != NULL))) {
         fprintf(stderr, "Error: Invalid parameters\n");
         return 1;
     }
+    for (int h = 0; h < num_heights; h++) {
+        if (heights[h] > rows) {
+            fprintf(stderr, "Error: Invalid parameters\n");
+            return 1;
+        }
+    }
+    for (int k = 0; k < num_shapes; k++) {
+        if (shapes[k].height > rows || shapes[k].width > cols) {
+            fprintf(stderr, "Error: Invalid parameters\n");
+            return 1;
+        }
+    }
+    
+    // Update values are raw readings; they get the grid's hash rounds
+    cell_update *updates = NULL;
+    long *batch_sizes = NULL;
+    int num_batches = 0;
+    if (updates_path != NULL) {
+        num_batches = read_update_batches(updates_path, rows, cols, &updates, &batch_sizes);
+        if (num_batches < 0) {
+            fprintf(stderr, "Error: Invalid update file %s\n", updates_path);
+            return 1;
+        }
+        long num_updates = 0;
+        for (int b = 0; b < num_batches; b++) {
+            num_updates += batch_sizes[b];
+        }
+        for (long u = 0; u < num_updates; u++) {
+            for (int w = 0; w < work_factor; w++) {
+                updates[u].value = hash(updates[u].value);
+            }
+        }
+    }
+    
+    // Tuned schedule and layout for this engine and shape: searched now, or
+    // loaded from the profile of an earlier --autotune run
+    const char *engine = stream ? "stream" : (fused ? "fused" : (tasks ? "tasks" : (numa ? "numa" : "default")));
+    if (autotune_reps > 0) {
+        engine_run run = { engine, rows, cols, seed, lower, upper, window_height, work_factor, part_a };
+        tuning_config best;
+        double best_time = autotune(fused || stream, autotune_reps, time_engine, &run, &best);
+        char desc[128];
+        tuning_describe(&best, desc, sizeof(desc));
+        fprintf(stderr, "Autotune (%s): %s, %.4f s\n", engine, desc, best_time);
+        tuning_save(engine, rows, cols, num_threads, &best, best_time);
+    } else {
+        tuning_load(engine, rows, cols, num_threads);
+    }
     
     // Print startup message and parameters
     printf("Starting heatmap_analysis\n");
-    printf("Parameters: columns=%d, rows=%d, seed=%lu, lower=%lu, upper=%lu, window_height=%d, verbose=%d, num_threads=%d, work_factor=%d\n\n",
+    printf("Parameters: columns=%d, rows=%ld, seed=%lu, lower=%lu, upper=%lu, window_height=%d, verbose=%d, num_threads=%d, work_factor=%d\n\n",
            cols, rows, seed, lower, upper, window_height, verbose, num_threads, work_factor);
     
+    int status = 0;
+    
     // Start timing immediately after reading command-line parameters
     double start_time = omp_get_wtime();
     
-    // Initialize heatmap
-    unsigned long *heatmap = initialize_heatmap(rows, cols, seed, lower, upper);
+    unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+    long long total_hotspots = 0;
+    unsigned long *heatmap = NULL;
+    unsigned long long *multi_sums = NULL;
+    rect_result *rect_results = NULL;
+    hotspot_report report = { 0 };
     
-    // Print original array if verbose (before transformation)
-    if (verbose) {
-        printf("A:\n");
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                if (j > 0) printf(",");
-                printf("%lu", heatmap[i * cols + j]);
-            }
-            printf("\n");
-        }
-        printf("\n");
+    // The streaming mode only keeps per-row counts when they are printed
+    padded_int *hotspots_per_row = NULL;
+    if (!stream || verbose) {
+        hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
     }
     
-    // Pre-process heatmap
-    preprocess_heatmap(heatmap, rows, cols, work_factor);
-    
-    // Combined parallel region for both Part A and Part B
-    // Maximizes parallel region length to reduce thread creation/termination overhead
-    unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
-    padded_int *hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
-    int total_hotspots = 0;
+    if (max_sums == NULL || (hotspots_per_row == NULL && (!stream || verbose))) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
     
-    #pragma omp parallel
-    {
-        // Part A: Calculate maximum range sums for each column
-        #pragma omp for schedule(static) nowait
-        for (int col = 0; col < cols; col++) {
-            unsigned long long max_sum = 0;
-            unsigned long long current_sum = 0;
-            
-            // Calculate initial window sum
-            for (int row = 0; row < window_height; row++) {
-                current_sum += heatmap[row * cols + col];
+    if (stream) {
+        // Rows generated on the fly into a ring buffer
+        stream_analysis(rows, cols, seed, lower, upper, window_height, work_factor, verbose,
+                        max_sums, hotspots_per_row, &total_hotspots);
+    } else if (fused) {
+        // Single pass over L2-sized row bands
+        heatmap = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+        if (heatmap == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        fused_analysis(heatmap, rows, cols, seed, lower, upper, work_factor, window_height,
+                       verbose, max_sums, hotspots_per_row, &total_hotspots);
+    } else if (numa) {
+        // Node-local row partitions, one owner per row in every phase
+        numa_stats locality;
+        numa_analysis(rows, cols, seed, lower, upper, work_factor, window_height, verbose,
+                      max_sums, hotspots_per_row, &total_hotspots, &locality);
+        fprintf(stderr, "NUMA: %d node(s), rows bound with mbind: %s, threads pinned: %s\n",
+                locality.nodes, locality.bound ? "yes" : "no", locality.pinned ? "yes" : "no");
+        if (locality.pages_sampled > 0) {
+            fprintf(stderr, "NUMA: %.1f%% of %ld sampled pages on the owner's node\n",
+                    100.0 * locality.pages_local / locality.pages_sampled, locality.pages_sampled);
+        } else {
+            fprintf(stderr, "NUMA: page locality unavailable (get_mempolicy failed)\n");
+        }
+    } else if (tasks) {
+        // Per-band tasks ordered by data dependencies only
+        heatmap = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+        if (heatmap == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        task_analysis(heatmap, rows, cols, seed, lower, upper, work_factor, window_height,
+                      verbose, max_sums, hotspots_per_row, &total_hotspots);
+    } else {
+        int applied_work = 0;
+        if (load_path != NULL) {
+            // Mapped grid, possibly hashed already
+            heatmap = loaded.data;
+            applied_work = loaded.work_factor;
+        } else {
+            // Initialize heatmap
+            heatmap = initialize_heatmap(rows, cols, seed, lower, upper);
+        }
+        
+        // Print original array if verbose (before transformation; only
+        // available when the grid has not been hashed yet)
+        if (verbose && applied_work == 0 && dump_prefix != NULL) {
+            if (dump_section(dump_prefix, "A", heatmap, rows, cols, 0) != 0) {
+                status = 1;
             }
-            max_sum = current_sum;
-            
-            // Slide the window down
-            for (int row = window_height; row < rows; row++) {
-                current_sum = current_sum - heatmap[(row - window_height) * cols + col] + heatmap[row * cols + col];
-                if (current_sum > max_sum) {
-                    max_sum = current_sum;
-                }
+        } else if (verbose && applied_work == 0) {
+            printf("A:\n");
+            write_grid_rows(heatmap, 0, rows, cols);
+            printf("\n");
+        }
+        
+        // Pre-process heatmap (only the hash rounds not applied yet)
+        preprocess_heatmap(heatmap, rows, cols, work_factor - applied_work);
+        
+        // Part A and Part B in one parallel region (a list of heights is
+        // answered from prefix sums below)
+        total_hotspots = analyze_heatmap(heatmap, rows, cols, window_height, part_a,
+                                         num_heights == 0 ? max_sums : NULL, hotspots_per_row);
+        
+        // Incremental updates on top of the full analysis
+        if (num_batches > 0) {
+            heatmap_incremental state;
+            incremental_init(&state, heatmap, rows, cols, window_height, hotspots_per_row, total_hotspots);
+            long first = 0;
+            for (int b = 0; b < num_batches; b++) {
+                incremental_apply(&state, &updates[first], batch_sizes[b]);
+                first += batch_sizes[b];
+                printf("Update batch %d: %ld update(s), total hotspots %lld\n", b + 1, batch_sizes[b],
+                       state.total_hotspots);
             }
-            
-            max_sums[col] = max_sum;
+            printf("\n");
+            memcpy(max_sums, state.max_sums, cols * sizeof(unsigned long long));
+            total_hotspots = state.total_hotspots;
+            incremental_free(&state);
         }
         
-        // Part B: Count local hotspots
-        // Reduction applied at the for directive level for clarity and correctness
-        #pragma omp for schedule(static) reduction(+:total_hotspots)
-        for (int i = 0; i < rows; i++) {
-            int row_hotspots = 0;
-            for (int j = 0; j < cols; j++) {
-                unsigned long current = heatmap[i * cols + j];
-                int is_hotspot = 1;
-                
-                // Check all 4 neighbors (up, down, left, right)
-                // Check up (only if not first row)
-                if (is_hotspot && i > 0 && heatmap[(i-1) * cols + j] >= current) {
-                    is_hotspot = 0;
-                }
-                // Check down (only if not last row)
-                if (is_hotspot && i < rows - 1 && heatmap[(i+1) * cols + j] >= current) {
-                    is_hotspot = 0;
-                }
-                // Check left (only if not first column)
-                if (is_hotspot && j > 0 && heatmap[i * cols + (j-1)] >= current) {
-                    is_hotspot = 0;
-                }
-                // Check right (only if not last column)
-                if (is_hotspot && j < cols - 1 && heatmap[i * cols + (j+1)] >= current) {
-                    is_hotspot = 0;
-                }
-                
-                if (is_hotspot) {
-                    row_hotspots++;
-                }
+        // Part A for every requested height from one set of column prefix sums
+        if (num_heights > 0) {
+            multi_sums = (unsigned long long*) malloc((size_t)num_heights * cols * sizeof(unsigned long long));
+            if (multi_sums == NULL) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                exit(1);
+            }
+            unsigned long long *prefix = build_column_prefix(heatmap, rows, cols);
+            max_window_sums_multi(prefix, rows, cols, heights, num_heights, multi_sums);
+            free(prefix);
+        }
+        
+        // Rectangular windows from a 128-bit summed-area table
+        if (num_shapes > 0) {
+            rect_results = (rect_result*) malloc(num_shapes * sizeof(rect_result));
+            if (rect_results == NULL) {
+                fprintf(stderr, "Error: Memory allocation failed\n");
+                exit(1);
             }
-            hotspots_per_row[i].count = row_hotspots;
-            total_hotspots += row_hotspots;
+            u128 *sat = build_summed_area_table(heatmap, rows, cols);
+            max_rect_sums(sat, rows, cols, shapes, num_shapes, rect_results);
+            free(sat);
+        }
+        
+        // Hotspot coordinates and the top-K ranking
+        if (hotspots_path != NULL || top_k > 0) {
+            collect_hotspots(heatmap, rows, cols, hotspots_path != NULL, top_k, &report);
         }
     }
     
     // Output results
-    if (verbose) {
+    if (num_heights > 0) {
+        // One max sums block per height (always printed in this mode)
+        for (int h = 0; h < num_heights; h++) {
+            printf("Window height %d:\n", heights[h]);
+            printf("Max sliding sums per column:\n");
+            write_sums(&multi_sums[(size_t)h * cols], cols);
+            printf("\n\n");
+        }
+    } else if (verbose && dump_prefix != NULL) {
+        if (dump_section(dump_prefix, "sums", (const unsigned long*)max_sums, 1, cols, 0) != 0) {
+            status = 1;
+        }
+    } else if (verbose) {
         // Print maximum sliding sums per column
         printf("Max sliding sums per column:\n");
-        for (int col = 0; col < cols; col++) {
-            if (col > 0) printf(",");
-            printf("%llu", max_sums[col]);
-        }
+        write_sums(max_sums, cols);
         printf("\n\n");
-        
+    }
+    
+    if (num_shapes > 0) {
+        printf("Max rectangle sums:\n");
+        for (int k = 0; k < num_shapes; k++) {
+            char digits[40];
+            printf("%dx%d: %s at row %ld, column %d\n", shapes[k].height, shapes[k].width,
+                   format_u128(rect_results[k].sum, digits), rect_results[k].row, rect_results[k].col);
+        }
+        printf("\n");
+    }
+    
+    if (top_k > 0) {
+        printf("Top %d hotspots:\n", top_k);
+        for (int k = 0; k < report.top_count; k++) {
+            printf("%d. row %ld, column %d: %lu\n", k + 1, report.top[k].row, report.top[k].col,
+                   report.top[k].value);
+        }
+        printf("\n");
+    }
+    
+    if (verbose && dump_prefix != NULL) {
+        unsigned long *counts = (unsigned long*) malloc(rows * sizeof(unsigned long));
+        if (counts == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        #pragma omp parallel for schedule(static)
+        for (long row = 0; row < rows; row++) {
+            counts[row] = hotspots_per_row[row].count;
+        }
+        if (dump_section(dump_prefix, "hotspots", counts, rows, 1, 0) != 0) {
+            status = 1;
+        }
+        free(counts);
+    } else if (verbose) {
         // Print hotspots per row
         printf("Hotspots per row:\n");
-        for (int row = 0; row < rows; row++) {
-            printf("Row %d: %d hotspot(s)\n", row, hotspots_per_row[row].count);
-        }
+        write_hotspot_counts(hotspots_per_row, rows);
         printf("\n");
     }
     
-    printf("Total hotspots found: %d\n", total_hotspots);
+    printf("Total hotspots found: %lld\n", total_hotspots);
     
     // End timing immediately after output (as per speedup measurement spec)
     double end_time = omp_get_wtime();
     double elapsed_time = end_time - start_time;
     printf("Execution took %.4f s\n", elapsed_time);
+    profile_report();
+    
+    // Cache the preprocessed grid for later runs (not part of the timed region)
+    if (save_path != NULL && heatmap_file_write(save_path, heatmap, rows, cols, work_factor) != 0) {
+        status = 1;
+    }
+    if (hotspots_path != NULL && write_hotspot_list(hotspots_path, &report) != 0) {
+        status = 1;
+    }
     
     // Clean up
     free(max_sums);
+    free(multi_sums);
+    free(heights);
+    free(shapes);
+    free(rect_results);
+    free(updates);
+    free(batch_sizes);
+    hotspot_report_free(&report);
     free(hotspots_per_row);
-    free(heatmap);
+    if (load_path != NULL) {
+        heatmap_file_close(&loaded);
+    } else {
+        free(heatmap);
+    }
     
-    return 0;
+    return status;
 }
\ No newline at end of file
@@ -1,79 +1,66 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <omp.h>
+#include "heatmap_kernels.h"
+#include "heatmap_quick.h"
+#include "phase_profile.h"
+#include "text_output.h"
+#include "tuning.h"
 
-// Cache line size to prevent false sharing
-#define CACHE_LINE_SIZE 64
-
-// Padded integer to avoid false sharing between threads
+// One silent quick analysis, timed by the autotuner
 typedef struct {
-    int count;
-    char padding[CACHE_LINE_SIZE - sizeof(int)];
-} padded_int;
-
-// Hash function
-unsigned long hash(unsigned long x) {
-    x ^= (x >> 21);
-    x *= 2654435761UL;
-    x ^= (x >> 13);
-    x *= 2654435761UL;
-    x ^= (x >> 17);
-    return x;
-}
-
-// Concatenate function
-unsigned concatenate(unsigned x, unsigned y) {
-    unsigned pow = 10;
-    while (y >= pow)
-        pow *= 10;
-    return x * pow + y;
-}
-
-// my_rand function
-unsigned long my_rand(unsigned long* state, unsigned long lower, unsigned long upper) {
-    *state ^= *state >> 12;
-    *state ^= *state << 25;
-    *state ^= *state >> 27;
-    unsigned long result = (*state * 0x2545F4914F6CDD1DULL);
-    unsigned long range = (upper > lower) ? (upper - lower) : 0UL;
-    return (range > 0) ? (result % range + lower) : lower;
-}
+    long rows;
+    int cols;
+    unsigned long seed;
+    unsigned long lower;
+    unsigned long upper;
+    int window_height;
+    int work_factor;
+} quick_run;
 
-// Initialize heatmap with random values
-unsigned long* initialize_heatmap(int rows, int cols, unsigned long seed, unsigned long lower, unsigned long upper) {
-    // Allocate flat 1D array to represent 2D matrix
-    unsigned long *heatmap = (unsigned long*) malloc(rows * cols * sizeof(unsigned long));
-    
-    if (heatmap == NULL) {
+static double time_quick(void *ctx) {
+    const quick_run *run = (const quick_run*)ctx;
+    double start_time = omp_get_wtime();
+    unsigned long *heatmap = (unsigned long*) malloc((size_t)run->rows * run->cols * sizeof(unsigned long));
+    padded_int *hotspots_per_row = (padded_int*) calloc(run->rows, sizeof(padded_int));
+    unsigned long long *max_sums = (unsigned long long*) malloc(run->cols * sizeof(unsigned long long));
+    if (heatmap == NULL || hotspots_per_row == NULL || max_sums == NULL) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         exit(1);
     }
-    
-    // Fill the array with random values in range [lower, upper)
-    #pragma omp parallel for schedule(static)
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            unsigned long s = seed * concatenate(i, j);
-            heatmap[i * cols + j] = my_rand(&s, lower, upper);
+    row_generator gen;
+    row_generator_init(&gen, run->cols, run->seed, run->lower, run->upper);
+    long long total_hotspots = 0;
+    if (quick_scan(heatmap, run->rows, run->cols, &gen, run->work_factor, hotspots_per_row,
+                   &total_hotspots) == -1) {
+        #pragma omp parallel
+        {
+            window_sums_rows(heatmap, run->rows, run->cols, run->window_height, max_sums);
         }
     }
-    
-    return heatmap;
+    row_generator_free(&gen);
+    free(max_sums);
+    free(hotspots_per_row);
+    free(heatmap);
+    return omp_get_wtime() - start_time;
 }
 
-// Pre-process heatmap by applying hash function work_factor times
-void preprocess_heatmap(unsigned long *heatmap, int rows, int cols, int work_factor) {
-    // Apply hash function work_factor times to each element
-    #pragma omp parallel for collapse(2) schedule(static)
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            unsigned long val = heatmap[i * cols + j];
-            for (int w = 0; w < work_factor; w++) {
-                val = hash(val);
-            }
-            heatmap[i * cols + j] = val;
-        }
+// Raw rows for the "A:" section, generated into their (not yet used) grid slots
+typedef struct {
+    const row_generator *gen;
+    unsigned long *heatmap;
+} raw_rows;
+
+static size_t render_raw_rows(char *out, long begin, long end, const void *ctx) {
+    const raw_rows *raw = (const raw_rows*)ctx;
+    int cols = raw->gen->cols;
+    char *p = out;
+    for (long i = begin; i < end; i++) {
+        unsigned long *row = &raw->heatmap[(size_t)i * cols];
+        generate_row(raw->gen, row, i);
+        p += format_row(p, row, cols);
     }
+    return p - out;
 }
 
 int main(int argc, char *argv[]) {
@@ -85,7 +72,7 @@ int main(int argc, char *argv[]) {
     
     // Parse command-line arguments
     int cols = atoi(argv[1]);
-    int rows = atoi(argv[2]);
+    long rows = strtol(argv[2], NULL, 10);
     unsigned long seed = strtoul(argv[3], NULL, 10);  
     unsigned long lower = strtoul(argv[4], NULL, 10); 
     unsigned long upper = strtoul(argv[5], NULL, 10); 
@@ -96,6 +83,7 @@ int main(int argc, char *argv[]) {
     
     // Set number of OpenMP threads
     omp_set_num_threads(num_threads);
+    profile_init("heatmap_analysis_quick");
     
     // Validate input
     if (rows <= 0 || cols <= 0 || window_height <= 0 || window_height > rows || upper <= lower) {
@@ -103,113 +91,69 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    // Tuned band size and layout: searched when HEATMAP_AUTOTUNE=REPS is set,
+    // otherwise loaded from the profile of an earlier autotuning run
+    const char *autotune_env = getenv("HEATMAP_AUTOTUNE");
+    int autotune_reps = (autotune_env != NULL) ? atoi(autotune_env) : 0;
+    if (autotune_reps > 0) {
+        quick_run run = { rows, cols, seed, lower, upper, window_height, work_factor };
+        tuning_config best;
+        double best_time = autotune(1, autotune_reps, time_quick, &run, &best);
+        char desc[128];
+        tuning_describe(&best, desc, sizeof(desc));
+        fprintf(stderr, "Autotune (quick): %s, %.4f s\n", desc, best_time);
+        tuning_save("quick", rows, cols, num_threads, &best, best_time);
+    } else {
+        tuning_load("quick", rows, cols, num_threads);
+    }
+    
     // Print startup message and parameters
     printf("Starting heatmap_analysis\n");
-    printf("Parameters: columns=%d, rows=%d, seed=%lu, lower=%lu, upper=%lu, window_height=%d, verbose=%d, num_threads=%d, work_factor=%d\n\n",
+    printf("Parameters: columns=%d, rows=%ld, seed=%lu, lower=%lu, upper=%lu, window_height=%d, verbose=%d, num_threads=%d, work_factor=%d\n\n",
            cols, rows, seed, lower, upper, window_height, verbose, num_threads, work_factor);
     
     // Start timing immediately after reading command-line parameters
     double start_time = omp_get_wtime();
     
-    // Initialize heatmap
-    unsigned long *heatmap = initialize_heatmap(rows, cols, seed, lower, upper);
+    // Rows are generated and hashed lazily, band by band, right before they
+    // are scanned, so an early zero row skips the rest of the grid
+    unsigned long *heatmap = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+    padded_int *hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
+    if (heatmap == NULL || hotspots_per_row == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
     
-    // Print original array if verbose (before transformation)
+    // Print original array if verbose (before transformation); the rows are
+    // regenerated by the scan below
     if (verbose) {
+        raw_rows raw = { &gen, heatmap };
         printf("A:\n");
-        for (int i = 0; i < rows; i++) {
-            for (int j = 0; j < cols; j++) {
-                if (j > 0) printf(",");
-                printf("%lu", heatmap[i * cols + j]);
-            }
-            printf("\n");
-        }
+        parallel_write(rows, (size_t)cols * 21, render_raw_rows, &raw);
         printf("\n");
     }
     
-    // Pre-process heatmap
-    preprocess_heatmap(heatmap, rows, cols, work_factor);
-    
     // Count local hotspots with early exit capability
-    padded_int *hotspots_per_row = (padded_int*) calloc(rows, sizeof(padded_int));
-    int total_hotspots = 0;
-    int early_exit_row = -1;
-    int found_zero = 0;  // Flag for early termination
-    
-    #pragma omp parallel
-    {
-        int local_hotspots = 0;
-        int local_exit_row = -1;
-        
-        #pragma omp for schedule(static) nowait
-        for (int i = 0; i < rows; i++) {
-            // Check if we should exit early
-            if (found_zero) {
-                continue;
-            }
-            
-            int row_hotspots = 0;
-            for (int j = 0; j < cols; j++) {
-                unsigned long current = heatmap[i * cols + j];
-                int is_hotspot = 1;
-                
-                // Check all 4 neighbors (up, down, left, right)
-                // Check up (only if not first row)
-                if (is_hotspot && i > 0 && heatmap[(i-1) * cols + j] >= current) {
-                    is_hotspot = 0;
-                }
-                // Check down (only if not last row)
-                if (is_hotspot && i < rows - 1 && heatmap[(i+1) * cols + j] >= current) {
-                    is_hotspot = 0;
-                }
-                // Check left (only if not first column)
-                if (is_hotspot && j > 0 && heatmap[i * cols + (j-1)] >= current) {
-                    is_hotspot = 0;
-                }
-                // Check right (only if not last column)
-                if (is_hotspot && j < cols - 1 && heatmap[i * cols + (j+1)] >= current) {
-                    is_hotspot = 0;
-                }
-                
-                if (is_hotspot) {
-                    row_hotspots++;
-                }
-            }
-            
-            hotspots_per_row[i].count = row_hotspots;
-            local_hotspots += row_hotspots;
-            
-            // Check for early exit condition
-            if (row_hotspots == 0) {
-                local_exit_row = i;
-                #pragma omp atomic write
-                found_zero = 1;
-                #pragma omp flush(found_zero)
-            }
-        }
-        
-        // Reduce local results
-        #pragma omp critical
-        {
-            total_hotspots += local_hotspots;
-            if (local_exit_row != -1 && (early_exit_row == -1 || local_exit_row < early_exit_row)) {
-                early_exit_row = local_exit_row;
-            }
-        }
-    }
+    long long total_hotspots = 0;
+    long early_exit_row = quick_scan(heatmap, rows, cols, &gen, work_factor, hotspots_per_row,
+                                     &total_hotspots);
     
     // Check if early exit occurred
     if (early_exit_row != -1) {
-        printf("Row %d contains no hotspots.\n", early_exit_row);
+        printf("Row %ld contains no hotspots.\n", early_exit_row);
         printf("Early exit.\n");
         
         // End timing immediately after output
         double end_time = omp_get_wtime();
         double elapsed_time = end_time - start_time;
         printf("Execution took %.4f s\n", elapsed_time);
+        profile_report();
         
         // Clean up
         free(hotspots_per_row);
+        row_generator_free(&gen);
         free(heatmap);
         return 0;
     }
@@ -218,56 +162,36 @@ int main(int argc, char *argv[]) {
     // Calculate maximum range sums for each column
     unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
     
-    #pragma omp parallel for schedule(static)
-    for (int col = 0; col < cols; col++) {
-        unsigned long long max_sum = 0;
-        unsigned long long current_sum = 0;
-        
-        // Calculate initial window sum
-        for (int row = 0; row < window_height; row++) {
-            current_sum += heatmap[row * cols + col];
-        }
-        max_sum = current_sum;
-        
-        // Slide the window down
-        for (int row = window_height; row < rows; row++) {
-            current_sum = current_sum - heatmap[(row - window_height) * cols + col] + heatmap[row * cols + col];
-            if (current_sum > max_sum) {
-                max_sum = current_sum;
-            }
-        }
-        
-        max_sums[col] = max_sum;
+    #pragma omp parallel
+    {
+        window_sums_rows(heatmap, rows, cols, window_height, max_sums);
     }
     
     // Output results
     if (verbose) {
         // Print maximum sliding sums per column
         printf("Max sliding sums per column:\n");
-        for (int col = 0; col < cols; col++) {
-            if (col > 0) printf(",");
-            printf("%llu", max_sums[col]);
-        }
+        write_sums(max_sums, cols);
         printf("\n\n");
         
         // Print hotspots per row
         printf("Hotspots per row:\n");
-        for (int row = 0; row < rows; row++) {
-            printf("Row %d: %d hotspot(s)\n", row, hotspots_per_row[row].count);
-        }
+        write_hotspot_counts(hotspots_per_row, rows);
         printf("\n");
     }
     
-    printf("Total hotspots found: %d\n", total_hotspots);
+    printf("Total hotspots found: %lld\n", total_hotspots);
     
     // End timing
     double end_time = omp_get_wtime();
     double elapsed_time = end_time - start_time;
     printf("Execution took %.4f s\n", elapsed_time);
+    profile_report();
     
     // Clean up
     free(max_sums);
     free(hotspots_per_row);
+    row_generator_free(&gen);
     free(heatmap);
     
     return 0;
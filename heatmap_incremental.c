@@ -0,0 +1,299 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "common.h"
+#include "heatmap_incremental.h"
+#include "hotspot_kernels.h"
+#include "window_prefix.h"
+
+static inline unsigned long long* column_tree(const heatmap_incremental *state, int c) {
+    return &state->trees[(size_t)c * 2 * state->leaves];
+}
+
+// Recompute the inner nodes above leaves [lo, hi] of one tree
+static void tree_refresh(unsigned long long *tree, long leaves, long lo, long hi) {
+    lo += leaves;
+    hi += leaves;
+    while (lo > 1) {
+        lo /= 2;
+        hi /= 2;
+        for (long n = lo; n <= hi; n++) {
+            tree[n] = (tree[2 * n] > tree[2 * n + 1]) ? tree[2 * n] : tree[2 * n + 1];
+        }
+    }
+}
+
+void incremental_init(heatmap_incremental *state, unsigned long *heatmap, long rows, int cols,
+                      int window_height, padded_int *hotspots_per_row, long long total_hotspots) {
+    state->heatmap = heatmap;
+    state->rows = rows;
+    state->cols = cols;
+    state->window_height = window_height;
+    state->num_windows = rows - window_height + 1;
+    state->leaves = 1;
+    while (state->leaves < state->num_windows) {
+        state->leaves *= 2;
+    }
+    state->trees = (unsigned long long*) malloc_or_die((size_t)cols * 2 * state->leaves * sizeof(unsigned long long));
+    state->max_sums = (unsigned long long*) malloc_or_die(cols * sizeof(unsigned long long));
+    state->hotspots_per_row = hotspots_per_row;
+    state->total_hotspots = total_hotspots;
+    
+    // Window sums from column prefix sums; unused leaves stay 0, which never
+    // exceeds a real (unsigned) window sum
+    unsigned long long *prefix = build_column_prefix(heatmap, rows, cols);
+    #pragma omp parallel for schedule(static)
+    for (int c = 0; c < cols; c++) {
+        unsigned long long *tree = column_tree(state, c);
+        for (long k = 0; k < state->leaves; k++) {
+            tree[state->leaves + k] = (k < state->num_windows)
+                ? prefix[(size_t)(k + window_height) * cols + c] - prefix[(size_t)k * cols + c]
+                : 0;
+        }
+        tree_refresh(tree, state->leaves, 0, state->leaves - 1);
+        state->max_sums[c] = tree[1];
+    }
+    free(prefix);
+}
+
+// Update sorted by cell, ties by position in the batch
+typedef struct {
+    size_t cell;
+    long index;
+} update_key;
+
+static int compare_update_key(const void *a, const void *b) {
+    const update_key *x = (const update_key*)a;
+    const update_key *y = (const update_key*)b;
+    if (x->cell != y->cell) return (x->cell < y->cell) ? -1 : 1;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+static int compare_cell(const void *a, const void *b) {
+    size_t x = *(const size_t*)a;
+    size_t y = *(const size_t*)b;
+    return (x > y) - (x < y);
+}
+
+// Updated cell by column, ties by position among the distinct cells
+typedef struct {
+    int col;
+    long index;
+} column_key;
+
+static int compare_column_key(const void *a, const void *b) {
+    const column_key *x = (const column_key*)a;
+    const column_key *y = (const column_key*)b;
+    if (x->col != y->col) return (x->col < y->col) ? -1 : 1;
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+static inline int cell_is_hotspot(const heatmap_incremental *state, size_t cell) {
+    long i = (long)(cell / state->cols);
+    int j = (int)(cell % state->cols);
+    const unsigned long *cur = &state->heatmap[(size_t)i * state->cols];
+    const unsigned long *up = (i > 0) ? cur - state->cols : NULL;
+    const unsigned long *down = (i < state->rows - 1) ? cur + state->cols : NULL;
+    return hotspot_at(up, cur, down, state->cols, j);
+}
+
+void incremental_apply(heatmap_incremental *state, const cell_update *updates, long count) {
+    if (count == 0) {
+        return;
+    }
+    long rows = state->rows;
+    int cols = state->cols;
+    
+    // Distinct cells, keeping the last update of each
+    update_key *keys = (update_key*) malloc_or_die(count * sizeof(update_key));
+    for (long u = 0; u < count; u++) {
+        keys[u].cell = (size_t)updates[u].row * cols + updates[u].col;
+        keys[u].index = u;
+    }
+    qsort(keys, count, sizeof(update_key), compare_update_key);
+    long distinct = 0;
+    for (long u = 0; u < count; u++) {
+        if (u + 1 < count && keys[u + 1].cell == keys[u].cell) continue;
+        keys[distinct++] = keys[u];
+    }
+    
+    // Cells whose hotspot status may change: the updated ones and their neighbors
+    size_t *affected = (size_t*) malloc_or_die(distinct * 5 * sizeof(size_t));
+    long num_affected = 0;
+    for (long u = 0; u < distinct; u++) {
+        size_t cell = keys[u].cell;
+        long i = (long)(cell / cols);
+        int j = (int)(cell % cols);
+        affected[num_affected++] = cell;
+        if (i > 0) affected[num_affected++] = cell - cols;
+        if (i < rows - 1) affected[num_affected++] = cell + cols;
+        if (j > 0) affected[num_affected++] = cell - 1;
+        if (j < cols - 1) affected[num_affected++] = cell + 1;
+    }
+    qsort(affected, num_affected, sizeof(size_t), compare_cell);
+    long unique = 0;
+    for (long k = 0; k < num_affected; k++) {
+        if (unique == 0 || affected[k] != affected[unique - 1]) {
+            affected[unique++] = affected[k];
+        }
+    }
+    num_affected = unique;
+    
+    // Updated cells grouped by column for the window-sum trees
+    column_key *by_column = (column_key*) malloc_or_die(distinct * sizeof(column_key));
+    for (long u = 0; u < distinct; u++) {
+        by_column[u].col = (int)(keys[u].cell % cols);
+        by_column[u].index = u;
+    }
+    qsort(by_column, distinct, sizeof(column_key), compare_column_key);
+    long *runs = (long*) malloc_or_die((distinct + 1) * sizeof(long));
+    long num_runs = 0;
+    for (long u = 0; u < distinct; u++) {
+        if (u == 0 || by_column[u].col != by_column[u - 1].col) {
+            runs[num_runs++] = u;
+        }
+    }
+    runs[num_runs] = distinct;
+    
+    unsigned char *was_hot = (unsigned char*) malloc_or_die(num_affected);
+    unsigned long long *deltas = (unsigned long long*) malloc_or_die(distinct * sizeof(unsigned long long));
+    long long total_change = 0;
+    
+    #pragma omp parallel
+    {
+        // Old status of every affected cell before any value changes
+        #pragma omp for schedule(static)
+        for (long k = 0; k < num_affected; k++) {
+            was_hot[k] = (unsigned char)cell_is_hotspot(state, affected[k]);
+        }
+        
+        // Distinct cells, so the writes never conflict
+        #pragma omp for schedule(static)
+        for (long u = 0; u < distinct; u++) {
+            unsigned long value = updates[keys[u].index].value;
+            deltas[u] = (unsigned long long)value - state->heatmap[keys[u].cell];
+            state->heatmap[keys[u].cell] = value;
+        }
+        
+        #pragma omp for schedule(static) reduction(+:total_change) nowait
+        for (long k = 0; k < num_affected; k++) {
+            int change = cell_is_hotspot(state, affected[k]) - was_hot[k];
+            if (change != 0) {
+                #pragma omp atomic
+                state->hotspots_per_row[affected[k] / cols].count += change;
+                total_change += change;
+            }
+        }
+        
+        // Window sums wrap modulo 2^64 like the full kernels, so each window
+        // covering an updated cell simply moves by the delta. A wrapped add
+        // can reorder the sums, so it cannot be applied lazily to a subtree
+        // maximum: every covering leaf is updated, O(window_height + log n)
+        // per cell.
+        #pragma omp for schedule(dynamic)
+        for (long r = 0; r < num_runs; r++) {
+            int c = by_column[runs[r]].col;
+            unsigned long long *tree = column_tree(state, c);
+            for (long k = runs[r]; k < runs[r + 1]; k++) {
+                long u = by_column[k].index;
+                long i = (long)(keys[u].cell / cols);
+                long lo = (i - state->window_height + 1 > 0) ? i - state->window_height + 1 : 0;
+                long hi = (i < state->num_windows - 1) ? i : state->num_windows - 1;
+                for (long w = lo; w <= hi; w++) {
+                    tree[state->leaves + w] += deltas[u];
+                }
+                tree_refresh(tree, state->leaves, lo, hi);
+            }
+            state->max_sums[c] = tree[1];
+        }
+    }
+    state->total_hotspots += total_change;
+    
+    free(deltas);
+    free(was_hot);
+    free(runs);
+    free(by_column);
+    free(affected);
+    free(keys);
+}
+
+void incremental_free(heatmap_incremental *state) {
+    free(state->trees);
+    free(state->max_sums);
+    state->trees = NULL;
+    state->max_sums = NULL;
+}
+
+int read_update_batches(const char *path, long rows, int cols, cell_update **updates,
+                        long **batch_sizes) {
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        return -1;
+    }
+    
+    long capacity = 1024;
+    long count = 0;
+    int batch_capacity = 16;
+    int num_batches = 0;
+    long batch_start = 0;
+    *updates = (cell_update*) malloc_or_die(capacity * sizeof(cell_update));
+    *batch_sizes = (long*) malloc_or_die(batch_capacity * sizeof(long));
+    
+    char line[256];
+    int at_end = 0;
+    while (!at_end) {
+        at_end = (fgets(line, sizeof(line), in) == NULL);
+        long row;
+        int col;
+        unsigned long value;
+        char extra;
+        
+        if (!at_end && sscanf(line, " %ld %d %lu %c", &row, &col, &value, &extra) == 3) {
+            if (row < 0 || row >= rows || col < 0 || col >= cols) {
+                break;
+            }
+            if (count == capacity) {
+                capacity *= 2;
+                *updates = (cell_update*) realloc(*updates, capacity * sizeof(cell_update));
+                if (*updates == NULL) {
+                    fprintf(stderr, "Error: Memory allocation failed\n");
+                    exit(1);
+                }
+            }
+            (*updates)[count].row = row;
+            (*updates)[count].col = col;
+            (*updates)[count].value = value;
+            count++;
+            continue;
+        }
+        
+        // A blank line (or the end of the file) closes a non-empty batch
+        if (at_end || strspn(line, " \t\r\n") == strlen(line)) {
+            if (count > batch_start) {
+                if (num_batches == batch_capacity) {
+                    batch_capacity *= 2;
+                    *batch_sizes = (long*) realloc(*batch_sizes, batch_capacity * sizeof(long));
+                    if (*batch_sizes == NULL) {
+                        fprintf(stderr, "Error: Memory allocation failed\n");
+                        exit(1);
+                    }
+                }
+                (*batch_sizes)[num_batches++] = count - batch_start;
+                batch_start = count;
+            }
+            continue;
+        }
+        break;
+    }
+    
+    fclose(in);
+    if (!at_end) {
+        free(*updates);
+        free(*batch_sizes);
+        *updates = NULL;
+        *batch_sizes = NULL;
+        return -1;
+    }
+    return num_batches;
+}
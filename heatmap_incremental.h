@@ -0,0 +1,49 @@
+#ifndef HEATMAP_INCREMENTAL_H
+#define HEATMAP_INCREMENTAL_H
+
+#include "common.h"
+
+// Incremental maintenance of the Part A/B results under batches of cell
+// updates. A batch only re-evaluates the updated cells and their 4
+// neighbors, and only touches the window sums of updated columns: an
+// updated cell costs O(window_height + log rows), one tree leaf per window
+// covering it plus the path to the root.
+
+typedef struct {
+    long row;
+    int col;
+    unsigned long value;    // new (preprocessed) value of the cell
+} cell_update;
+
+typedef struct {
+    unsigned long *heatmap;           // grid, updated in place
+    long rows;
+    int cols;
+    int window_height;
+    long num_windows;                 // rows - window_height + 1
+    long leaves;                      // num_windows rounded up to a power of 2
+    unsigned long long *trees;        // per column max segment tree over window sums
+    unsigned long long *max_sums;     // max window sum per column (tree roots)
+    padded_int *hotspots_per_row;     // caller's per-row counts, kept up to date
+    long long total_hotspots;
+} heatmap_incremental;
+
+// Build the window-sum trees of every column from the grid. The per-row
+// hotspot counts and their total come from a full Part B pass.
+void incremental_init(heatmap_incremental *state, unsigned long *heatmap, long rows, int cols,
+                      int window_height, padded_int *hotspots_per_row, long long total_hotspots);
+
+// Apply one batch. Updates of the same cell resolve to the last one; old
+// hotspot status is taken for all affected cells before any value changes,
+// so neighboring updates within a batch never see each other half-applied.
+void incremental_apply(heatmap_incremental *state, const cell_update *updates, long count);
+
+void incremental_free(heatmap_incremental *state);
+
+// Read "row col value" lines; blank lines end a batch. Returns the number
+// of batches (with malloc'd *updates and per-batch *batch_sizes) or -1 if
+// the file cannot be read or is malformed.
+int read_update_batches(const char *path, long rows, int cols, cell_update **updates,
+                        long **batch_sizes);
+
+#endif
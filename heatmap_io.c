@@ -0,0 +1,213 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <omp.h>
+#include "heatmap_io.h"
+
+_Static_assert(sizeof(heatmap_file_header) == HEATMAP_HEADER_SIZE, "heatmap header must be 64 bytes");
+
+// Rows copied per chunk when filling or converting a mapped grid
+#define IO_CHUNK_ROWS 64
+
+static int io_error(const char *what, const char *path) {
+    fprintf(stderr, "Error: %s %s: %s\n", what, path, strerror(errno));
+    return -1;
+}
+
+// Read one value of a foreign or compact layout as a native 64-bit value
+static inline unsigned long load_value(const unsigned char *p, int width, int swap) {
+    if (width == 8) {
+        uint64_t v;
+        memcpy(&v, p, 8);
+        return swap ? __builtin_bswap64(v) : v;
+    }
+    uint32_t v;
+    memcpy(&v, p, 4);
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+int heatmap_file_open(const char *path, int writable, heatmap_file *file) {
+    memset(file, 0, sizeof(*file));
+    
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return io_error("Cannot open", path);
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return io_error("Cannot stat", path);
+    }
+    
+    heatmap_file_header header;
+    if ((size_t)st.st_size < sizeof(header) || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        memcmp(header.magic, HEATMAP_FILE_MAGIC, sizeof(HEATMAP_FILE_MAGIC)) != 0) {
+        fprintf(stderr, "Error: %s is not a heatmap file\n", path);
+        close(fd);
+        return -1;
+    }
+    
+    int swap = (header.byte_order != HEATMAP_BYTE_ORDER);
+    if (swap) {
+        if (header.byte_order != __builtin_bswap32(HEATMAP_BYTE_ORDER)) {
+            fprintf(stderr, "Error: %s has an unknown byte order\n", path);
+            close(fd);
+            return -1;
+        }
+        header.version = __builtin_bswap32(header.version);
+        header.rows = __builtin_bswap64(header.rows);
+        header.cols = __builtin_bswap64(header.cols);
+        header.elem_width = __builtin_bswap32(header.elem_width);
+        header.work_factor = (int32_t)__builtin_bswap32((uint32_t)header.work_factor);
+        header.data_offset = __builtin_bswap64(header.data_offset);
+    }
+    
+    int width = (int)header.elem_width;
+    if (header.version != HEATMAP_FILE_VERSION || (width != 4 && width != 8) ||
+        header.rows == 0 || header.cols == 0 || header.cols > 0x7fffffff || header.work_factor < 0 ||
+        header.rows > UINT64_MAX / header.cols / width ||
+        header.data_offset < sizeof(header) || header.data_offset % width != 0 ||
+        header.data_offset + header.rows * header.cols * width > (uint64_t)st.st_size) {
+        fprintf(stderr, "Error: %s has an invalid or truncated header\n", path);
+        close(fd);
+        return -1;
+    }
+    
+    file->rows = (long)header.rows;
+    file->cols = (int)header.cols;
+    file->work_factor = header.work_factor;
+    file->map_size = (size_t)st.st_size;
+    
+    // Native 64-bit values are used straight from the page cache; a private
+    // mapping lets the caller hash them further without touching the file
+    int native = (width == 8 && !swap);
+    int prot = (native && writable) ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    int flags = (native && writable) ? MAP_PRIVATE : MAP_SHARED;
+    file->map = mmap(NULL, file->map_size, prot, flags, fd, 0);
+    close(fd);
+    if (file->map == MAP_FAILED) {
+        file->map = NULL;
+        return io_error("Cannot map", path);
+    }
+    
+    // The analysis streams through the grid once, in order
+    madvise(file->map, file->map_size, MADV_WILLNEED);
+    madvise(file->map, file->map_size, MADV_SEQUENTIAL);
+    
+    const unsigned char *values = (const unsigned char*)file->map + header.data_offset;
+    if (native) {
+        file->data = (unsigned long*)values;
+        return 0;
+    }
+    
+    // Compact or foreign-endian values are converted once into a private buffer
+    size_t count = (size_t)file->rows * file->cols;
+    file->data = (unsigned long*) malloc(count * sizeof(unsigned long));
+    if (file->data == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        heatmap_file_close(file);
+        return -1;
+    }
+    file->owns_data = 1;
+    
+    #pragma omp parallel for schedule(static)
+    for (size_t k = 0; k < count; k++) {
+        file->data[k] = load_value(values + k * width, width, swap);
+    }
+    
+    munmap(file->map, file->map_size);
+    file->map = NULL;
+    return 0;
+}
+
+void heatmap_file_close(heatmap_file *file) {
+    if (file->owns_data) {
+        free(file->data);
+    }
+    if (file->map != NULL) {
+        munmap(file->map, file->map_size);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+int heatmap_file_write(const char *path, const unsigned long *data, long rows, int cols, int work_factor) {
+    size_t data_bytes = (size_t)rows * cols * sizeof(unsigned long);
+    size_t file_size = HEATMAP_HEADER_SIZE + data_bytes;
+    
+    // Write a temporary file next to the target and rename it over the target
+    // at the end: path may be the file data is mapped from (--load=F --save=F),
+    // which truncating in place would wipe before it is copied
+    size_t tmp_len = strlen(path) + 32;
+    char *tmp_path = (char*) malloc(tmp_len);
+    if (tmp_path == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        return -1;
+    }
+    snprintf(tmp_path, tmp_len, "%s.tmp.%ld", path, (long)getpid());
+    
+    int fd = open(tmp_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        io_error("Cannot create", tmp_path);
+        free(tmp_path);
+        return -1;
+    }
+    if (ftruncate(fd, (off_t)file_size) != 0) {
+        io_error("Cannot resize", tmp_path);
+        close(fd);
+        unlink(tmp_path);
+        free(tmp_path);
+        return -1;
+    }
+    
+    unsigned char *map = (unsigned char*) mmap(NULL, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        io_error("Cannot map", tmp_path);
+        unlink(tmp_path);
+        free(tmp_path);
+        return -1;
+    }
+    madvise(map, file_size, MADV_SEQUENTIAL);
+    
+    heatmap_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HEATMAP_FILE_MAGIC, sizeof(HEATMAP_FILE_MAGIC));
+    header.version = HEATMAP_FILE_VERSION;
+    header.byte_order = HEATMAP_BYTE_ORDER;
+    header.rows = (uint64_t)rows;
+    header.cols = (uint64_t)cols;
+    header.elem_width = sizeof(unsigned long);
+    header.work_factor = work_factor;
+    header.data_offset = HEATMAP_HEADER_SIZE;
+    memcpy(map, &header, sizeof(header));
+    
+    // Threads fill disjoint row chunks of the mapping
+    unsigned char *values = map + HEATMAP_HEADER_SIZE;
+    size_t row_bytes = (size_t)cols * sizeof(unsigned long);
+    #pragma omp parallel for schedule(static)
+    for (long i = 0; i < rows; i += IO_CHUNK_ROWS) {
+        long n = (i + IO_CHUNK_ROWS < rows) ? IO_CHUNK_ROWS : rows - i;
+        memcpy(values + (size_t)i * row_bytes, data + (size_t)i * cols, (size_t)n * row_bytes);
+    }
+    
+    int status = 0;
+    if (msync(map, file_size, MS_SYNC) != 0) {
+        status = io_error("Cannot write", tmp_path);
+    }
+    munmap(map, file_size);
+    
+    if (status == 0 && rename(tmp_path, path) != 0) {
+        status = io_error("Cannot replace", path);
+    }
+    if (status != 0) {
+        unlink(tmp_path);
+    }
+    free(tmp_path);
+    return status;
+}
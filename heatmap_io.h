@@ -0,0 +1,52 @@
+#ifndef HEATMAP_IO_H
+#define HEATMAP_IO_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Binary heatmap file: a 64-byte header followed by rows x cols values in
+// row-major order. byte_order holds HEATMAP_BYTE_ORDER as written by the
+// producer, so a reader sees it byte-swapped when endianness differs.
+#define HEATMAP_FILE_MAGIC "HEATMAP"
+#define HEATMAP_FILE_VERSION 1
+#define HEATMAP_BYTE_ORDER 0x01020304u
+#define HEATMAP_HEADER_SIZE 64
+
+typedef struct {
+    char magic[8];          // "HEATMAP\0"
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t rows;
+    uint64_t cols;
+    uint32_t elem_width;    // bytes per value: 8, or 4 for compact sensor grids
+    int32_t work_factor;    // hash rounds already applied (0 = raw values)
+    uint64_t data_offset;   // start of the values, from the beginning of the file
+    uint8_t reserved[16];
+} heatmap_file_header;
+
+// A loaded heatmap. data is either a view into the file mapping (zero copy)
+// or a private buffer when the values had to be converted.
+typedef struct {
+    unsigned long *data;
+    long rows;
+    int cols;
+    int work_factor;        // hash rounds applied to data
+    void *map;              // file mapping, NULL if none
+    size_t map_size;
+    int owns_data;          // data was malloc'd
+} heatmap_file;
+
+// Map a heatmap file. With writable set the values may be modified in place
+// (private copy-on-write mapping, never written back). Returns 0 on success,
+// -1 after printing an error.
+int heatmap_file_open(const char *path, int writable, heatmap_file *file);
+
+// Release a loaded heatmap
+void heatmap_file_close(heatmap_file *file);
+
+// Write a grid of 64-bit values through a shared mapping of a temporary file
+// that then replaces path (so path may be the file the grid is loaded from).
+// Returns 0 on success, -1 after printing an error.
+int heatmap_file_write(const char *path, const unsigned long *data, long rows, int cols, int work_factor);
+
+#endif
@@ -0,0 +1,344 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_kernels.h"
+#include "hotspot_kernels.h"
+#include "phase_profile.h"
+#include "tuning.h"
+
+void row_generator_init(row_generator *gen, int cols, unsigned long seed,
+                        unsigned long lower, unsigned long upper) {
+    gen->pow10 = (unsigned*) malloc(cols * sizeof(unsigned));
+    if (gen->pow10 == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    
+    // Same loop as concatenate(), including its 32-bit wrap-around
+    for (int j = 0; j < cols; j++) {
+        unsigned pow = 10;
+        while ((unsigned)j >= pow)
+            pow *= 10;
+        gen->pow10[j] = pow;
+    }
+    
+    gen->cols = cols;
+    gen->seed = seed;
+    gen->lower = lower;
+    gen->range = (upper > lower) ? (upper - lower) : 0UL;
+    gen->magic = 0;
+    gen->shift = 0;
+    gen->add_step = 0;
+    
+    // Granlund-Montgomery division by an invariant range (64-bit numerators).
+    // With l = floor(log2(range)), m = floor(2^(64+l) / range) + 1 fits in 64
+    // bits when the rounding error is small enough; otherwise the 65-bit
+    // magic is applied as a multiply-high, an add step and a shift.
+    unsigned long d = gen->range;
+    if (d != 0 && (d & (d - 1)) != 0) {
+        int l = 63 - __builtin_clzl(d);
+        unsigned __int128 dividend = (unsigned __int128)1 << (64 + l);
+        unsigned long m = (unsigned long)(dividend / d);
+        unsigned long rem = (unsigned long)(dividend % d);
+        if (d - rem < (1UL << l)) {
+            gen->magic = m + 1;
+            gen->shift = l;
+        } else {
+            // 2^(65+l) / d, minus the implicit 2^64
+            m += m;
+            unsigned long twice_rem = rem + rem;
+            if (twice_rem >= d || twice_rem < rem) {
+                m += 1;
+            }
+            gen->magic = m + 1;
+            gen->shift = l;
+            gen->add_step = 1;
+        }
+    }
+}
+
+void row_generator_free(row_generator *gen) {
+    free(gen->pow10);
+    gen->pow10 = NULL;
+}
+
+// High 64 bits of a 64x64-bit product from 32-bit halves, so that the
+// reduction vectorizes (there is no 64-bit multiply-high instruction)
+static inline unsigned long mulhi64(unsigned long a, unsigned long b) {
+    unsigned long a_lo = (unsigned)a, a_hi = a >> 32;
+    unsigned long b_lo = (unsigned)b, b_hi = b >> 32;
+    unsigned long lo_lo = a_lo * b_lo;
+    unsigned long hi_lo = a_hi * b_lo;
+    unsigned long lo_hi = a_lo * b_hi;
+    unsigned long cross = (lo_lo >> 32) + (unsigned)hi_lo + lo_hi;
+    return (hi_lo >> 32) + (cross >> 32) + a_hi * b_hi;
+}
+
+// Reductions of the xorshift output to [lower, lower + range)
+enum { REDUCE_EMPTY, REDUCE_MASK, REDUCE_MAGIC, REDUCE_MAGIC_ADD };
+
+// my_rand() for every cell of row i, vectorized across columns. reduce is a
+// constant at every call site, so each reduction gets its own loop.
+static inline __attribute__((always_inline))
+void generate_cells(unsigned long *row, const unsigned *pow10, unsigned x, int cols,
+                    const row_generator *gen, int reduce) {
+    unsigned long seed = gen->seed;
+    unsigned long d = gen->range;
+    unsigned long lower = gen->lower;
+    unsigned long magic = gen->magic;
+    int shift = gen->shift;
+    
+    #pragma omp simd
+    for (int j = 0; j < cols; j++) {
+        unsigned long s = seed * (unsigned)(x * pow10[j] + (unsigned)j);
+        s ^= s >> 12;
+        s ^= s << 25;
+        s ^= s >> 27;
+        unsigned long n = s * 0x2545F4914F6CDD1DULL;
+        
+        if (reduce == REDUCE_EMPTY) {
+            row[j] = lower;
+        } else if (reduce == REDUCE_MASK) {
+            row[j] = (n & (d - 1)) + lower;
+        } else {
+            unsigned long q = mulhi64(n, magic);
+            if (reduce == REDUCE_MAGIC_ADD) {
+                q = ((n - q) >> 1) + q;
+            }
+            row[j] = n - (q >> shift) * d + lower;
+        }
+    }
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default")))
+void generate_row(const row_generator *gen, unsigned long *row, long i) {
+    unsigned long d = gen->range;
+    unsigned x = (unsigned)i;
+    
+    if (d == 0) {
+        generate_cells(row, gen->pow10, x, gen->cols, gen, REDUCE_EMPTY);
+    } else if ((d & (d - 1)) == 0) {
+        generate_cells(row, gen->pow10, x, gen->cols, gen, REDUCE_MASK);
+    } else if (gen->add_step) {
+        generate_cells(row, gen->pow10, x, gen->cols, gen, REDUCE_MAGIC_ADD);
+    } else {
+        generate_cells(row, gen->pow10, x, gen->cols, gen, REDUCE_MAGIC);
+    }
+}
+
+void generate_row_reference(unsigned long *row, long i, int cols, unsigned long seed,
+                            unsigned long lower, unsigned long upper) {
+    for (int j = 0; j < cols; j++) {
+        unsigned long s = seed * concatenate((unsigned)i, (unsigned)j);
+        row[j] = my_rand(&s, lower, upper);
+    }
+}
+
+// Initialize heatmap with random values
+unsigned long* initialize_heatmap(long rows, int cols, unsigned long seed, unsigned long lower, unsigned long upper) {
+    // Allocate flat 1D array to represent 2D matrix
+    unsigned long *heatmap = (unsigned long*) malloc((size_t)rows * cols * sizeof(unsigned long));
+    
+    if (heatmap == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    
+    initialize_heatmap_into(heatmap, rows, cols, seed, lower, upper);
+    return heatmap;
+}
+
+void initialize_heatmap_into(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                             unsigned long lower, unsigned long upper) {
+    // Fill the array with random values in range [lower, upper)
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    #pragma omp parallel
+    {
+        profile_enter(PROF_INIT);
+        #pragma omp for schedule(runtime) nowait
+        for (long i = 0; i < rows; i++) {
+            generate_row(&gen, &heatmap[(size_t)i * cols], i);
+        }
+        profile_leave(PROF_INIT);
+    }
+    row_generator_free(&gen);
+}
+
+// Pre-process heatmap by applying hash function work_factor times
+void preprocess_heatmap(unsigned long *heatmap, long rows, int cols, int work_factor) {
+    // Resolve the hash variant once, outside the parallel region
+    hash_selected();
+    
+    // Same row loop and schedule as initialize_heatmap(), so every row is
+    // hashed by the thread that first touched its pages (guaranteed for
+    // static schedules)
+    #pragma omp parallel
+    {
+        profile_enter(PROF_PREPROCESS);
+        #pragma omp for schedule(runtime) nowait
+        for (long i = 0; i < rows; i++) {
+            hash_row(&heatmap[(size_t)i * cols], cols, work_factor);
+        }
+        profile_leave(PROF_PREPROCESS);
+    }
+}
+
+// Count local hotspots in row i (strictly greater than all existing 4 neighbors)
+int count_row_hotspots(const unsigned long *heatmap, long rows, int cols, long i) {
+    const unsigned long *cur = &heatmap[(size_t)i * cols];
+    const unsigned long *up = (i > 0) ? cur - cols : NULL;
+    const unsigned long *down = (i < rows - 1) ? cur + cols : NULL;
+    return hotspots_row(up, cur, down, cols);
+}
+
+int band_rows_for_cache(int cols, int num_threads) {
+    if (tuning.band_rows > 0) {
+        return tuning.band_rows * num_threads;
+    }
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 <= 0) {
+        l2 = DEFAULT_L2_BYTES;
+    }
+    long row_bytes = (long)cols * sizeof(unsigned long);
+    long band = (l2 / 2) * num_threads / row_bytes;
+    return (band < 1) ? 1 : (band > 4096 ? 4096 : (int)band);
+}
+
+int column_block_size(int cols, int num_threads) {
+    if (tuning.col_block > 0) {
+        return tuning.col_block;
+    }
+    
+    // Shrink the block until every thread gets one (keeps whole vectors per row)
+    int block = PART_A_COL_BLOCK;
+    while (block > 8 && (cols + block - 1) / block < num_threads) {
+        block /= 2;
+    }
+    return block;
+}
+
+// Row-major window sum update for one column block. Each row is a contiguous
+// run of columns, so adds, subtracts and unsigned max vectorize; the clones
+// are picked at load time according to the CPU.
+__attribute__((target_clones("avx512f", "avx2", "default")))
+void window_sums_step(const unsigned long *in_row, const unsigned long *out_row, long row,
+                      int window_height, int n, unsigned long long *cur_sums,
+                      unsigned long long *max_sums) {
+    if (row < window_height - 1) {
+        // Filling the first window
+        #pragma omp simd
+        for (int c = 0; c < n; c++) {
+            cur_sums[c] += in_row[c];
+        }
+    } else if (row == window_height - 1) {
+        // First complete window initializes the maximum
+        #pragma omp simd
+        for (int c = 0; c < n; c++) {
+            unsigned long long sum = cur_sums[c] + in_row[c];
+            cur_sums[c] = sum;
+            max_sums[c] = sum;
+        }
+    } else {
+        // Slide the window down
+        #pragma omp simd
+        for (int c = 0; c < n; c++) {
+            unsigned long long sum = cur_sums[c] - out_row[c] + in_row[c];
+            cur_sums[c] = sum;
+            max_sums[c] = (sum > max_sums[c]) ? sum : max_sums[c];
+        }
+    }
+}
+
+void window_sums_block(const unsigned long *heatmap, int cols, long row_begin, long row_end,
+                       int window_height, int col_start, int col_end,
+                       unsigned long long *cur_sums, unsigned long long *max_sums) {
+    for (long row = row_begin; row < row_end; row++) {
+        const unsigned long *in_row = &heatmap[(size_t)row * cols + col_start];
+        const unsigned long *out_row = (row >= window_height) ? in_row - (size_t)window_height * cols : NULL;
+        window_sums_step(in_row, out_row, row, window_height, col_end - col_start, cur_sums, max_sums);
+    }
+}
+
+// Part A, column kernel: each thread walks whole columns with stride cols
+void window_sums_columns(const unsigned long *heatmap, long rows, int cols, int window_height,
+                         unsigned long long *max_sums) {
+    profile_enter(PROF_PART_A);
+    #pragma omp for schedule(runtime) nowait
+    for (int col = 0; col < cols; col++) {
+        unsigned long long max_sum = 0;
+        unsigned long long current_sum = 0;
+        
+        // Calculate initial window sum
+        for (long row = 0; row < window_height; row++) {
+            current_sum += heatmap[(size_t)row * cols + col];
+        }
+        max_sum = current_sum;
+        
+        // Slide the window down
+        for (long row = window_height; row < rows; row++) {
+            current_sum = current_sum - heatmap[(size_t)(row - window_height) * cols + col] + heatmap[(size_t)row * cols + col];
+            if (current_sum > max_sum) {
+                max_sum = current_sum;
+            }
+        }
+        
+        max_sums[col] = max_sum;
+    }
+    profile_leave(PROF_PART_A);
+}
+
+// Part A, row kernel: threads split column blocks and sweep all rows in order
+void window_sums_rows(const unsigned long *heatmap, long rows, int cols, int window_height,
+                      unsigned long long *max_sums) {
+    int block = column_block_size(cols, omp_get_num_threads());
+    int num_blocks = (cols + block - 1) / block;
+    
+    profile_enter(PROF_PART_A);
+    #pragma omp for schedule(runtime) nowait
+    for (int cb = 0; cb < num_blocks; cb++) {
+        int col_start = cb * block;
+        int col_end = (col_start + block < cols) ? col_start + block : cols;
+        unsigned long long cur_sums[PART_A_COL_BLOCK] = {0};
+        
+        window_sums_block(heatmap, cols, 0, rows, window_height, col_start, col_end,
+                          cur_sums, &max_sums[col_start]);
+    }
+    profile_leave(PROF_PART_A);
+}
+
+long long analyze_heatmap(const unsigned long *heatmap, long rows, int cols, int window_height,
+                          part_a_kernel part_a, unsigned long long *max_sums,
+                          padded_int *hotspots_per_row) {
+    long long total_hotspots = 0;
+    
+    // Combined parallel region for both Part A and Part B
+    // Maximizes parallel region length to reduce thread creation/termination overhead
+    #pragma omp parallel
+    {
+        // Part A: Calculate maximum range sums for each column
+        if (max_sums != NULL) {
+            if (part_a == PART_A_COLUMNS) {
+                window_sums_columns(heatmap, rows, cols, window_height, max_sums);
+            } else {
+                window_sums_rows(heatmap, rows, cols, window_height, max_sums);
+            }
+        }
+        
+        // Part B: Count local hotspots
+        // Reduction applied at the for directive level for clarity and correctness
+        // (nowait: the end of the region is the barrier)
+        profile_enter(PROF_PART_B);
+        #pragma omp for schedule(runtime) reduction(+:total_hotspots) nowait
+        for (long i = 0; i < rows; i++) {
+            int row_hotspots = count_row_hotspots(heatmap, rows, cols, i);
+            hotspots_per_row[i].count = row_hotspots;
+            total_hotspots += row_hotspots;
+        }
+        profile_leave(PROF_PART_B);
+    }
+    
+    return total_hotspots;
+}
@@ -0,0 +1,97 @@
+#ifndef HEATMAP_KERNELS_H
+#define HEATMAP_KERNELS_H
+
+#include <stddef.h>
+#include "common.h"
+
+// Columns handled together by one thread in the row-major Part A kernel
+// (running sums and maxima of a block stay in L1)
+#define PART_A_COL_BLOCK 256
+
+// Fallback L2 size when the cache geometry cannot be queried
+#define DEFAULT_L2_BYTES (1024 * 1024)
+
+// Part A kernel selection
+typedef enum {
+    PART_A_ROWS,     // row-major sweep over column blocks (vectorized)
+    PART_A_COLUMNS   // one strided walk down each column
+} part_a_kernel;
+
+// Row generator: everything about a row of the (unprocessed) heatmap that
+// does not depend on the row index, computed once. Every value is a pure
+// function of (seed, i, j); row and column indices enter concatenate() as
+// 32-bit unsigned values, exactly as in the original int arithmetic.
+typedef struct {
+    unsigned *pow10;          // concatenate() multiplier of each column
+    int cols;
+    unsigned long seed;
+    unsigned long lower;
+    unsigned long range;      // upper - lower, 0 if empty
+    unsigned long magic;      // exact division by range: multiply-high ...
+    int shift;                // ... then shift (with the add step if add_step)
+    int add_step;
+} row_generator;
+
+void row_generator_init(row_generator *gen, int cols, unsigned long seed,
+                        unsigned long lower, unsigned long upper);
+void row_generator_free(row_generator *gen);
+
+// Fill row i: the xorshift runs vectorized across columns and % range is
+// replaced by the precomputed division, bit-identical to my_rand()
+void generate_row(const row_generator *gen, unsigned long *row, long i);
+
+// Scalar reference: concatenate() and my_rand() per cell
+void generate_row_reference(unsigned long *row, long i, int cols, unsigned long seed,
+                            unsigned long lower, unsigned long upper);
+
+// Initialize heatmap with random values
+unsigned long* initialize_heatmap(long rows, int cols, unsigned long seed, unsigned long lower, unsigned long upper);
+
+// Same, into a caller-provided grid of rows x cols values
+void initialize_heatmap_into(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                             unsigned long lower, unsigned long upper);
+
+// Pre-process heatmap by applying hash function work_factor times
+void preprocess_heatmap(unsigned long *heatmap, long rows, int cols, int work_factor);
+
+// Count local hotspots in row i (strictly greater than all existing 4 neighbors)
+int count_row_hotspots(const unsigned long *heatmap, long rows, int cols, long i);
+
+// Rows per band so that each thread's share of a band occupies about half
+// of its L2, leaving room for halo rows and outgoing window rows
+// (tuning.band_rows per thread when set)
+int band_rows_for_cache(int cols, int num_threads);
+
+// Column block width for kernels that split columns across threads:
+// PART_A_COL_BLOCK, halved until every thread gets a block (min 8), or
+// tuning.col_block when set
+int column_block_size(int cols, int num_threads);
+
+// Advance the running window sums of one column block by one row.
+// in_row/out_row point at the block's first column; out_row is the row
+// leaving the window (ignored while row < window_height). cur_sums/max_sums
+// hold n entries and the state left by the previous rows (zeroed at row 0).
+void window_sums_step(const unsigned long *in_row, const unsigned long *out_row, long row,
+                      int window_height, int n, unsigned long long *cur_sums,
+                      unsigned long long *max_sums);
+
+// Advance running window sums of columns [col_start, col_end) through rows
+// [row_begin, row_end) of a flat grid, via window_sums_step()
+void window_sums_block(const unsigned long *heatmap, int cols, long row_begin, long row_end,
+                       int window_height, int col_start, int col_end,
+                       unsigned long long *cur_sums, unsigned long long *max_sums);
+
+// Part A kernels. Both are orphaned worksharing loops (nowait) and must be
+// called by every thread of an enclosing parallel region.
+void window_sums_columns(const unsigned long *heatmap, long rows, int cols, int window_height,
+                         unsigned long long *max_sums);
+void window_sums_rows(const unsigned long *heatmap, long rows, int cols, int window_height,
+                      unsigned long long *max_sums);
+
+// Part A (skipped when max_sums is NULL) and Part B over a hashed grid in
+// one parallel region; fills hotspots_per_row and returns the total
+long long analyze_heatmap(const unsigned long *heatmap, long rows, int cols, int window_height,
+                          part_a_kernel part_a, unsigned long long *max_sums,
+                          padded_int *hotspots_per_row);
+
+#endif
@@ -0,0 +1,342 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <mpi.h>
+#include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_kernels.h"
+#include "hotspot_kernels.h"
+#include "text_output.h"
+
+// Multi-process heatmap analysis (MPI + OpenMP): rank r of P owns the rows
+// [rows * r / P, rows * (r + 1) / P) and generates and preprocesses only
+// those, with the row generator of the single-process program (every value
+// is a pure function of seed, row and column). Neighboring ranks exchange
+// one-row halos for Part B. For Part A every rank reduces the windows that
+// lie inside its band and carries the sums of its first and last
+// window_height - 1 rows across the band boundaries, so windows spanning
+// several bands are exact as well. Only rank 0 prints; the output is
+// identical to heatmap_analysis with the same arguments.
+
+// Abort the whole job: exit() in one rank would leave the others waiting
+static void fail_alloc(void) {
+    fprintf(stderr, "Error: Memory allocation failed\n");
+    MPI_Abort(MPI_COMM_WORLD, 1);
+}
+
+// First row owned by rank r of size
+static long band_row(long rows, int r, int size) {
+    return rows * r / size;
+}
+
+// Column sums of rows [first, first + m) for m = 1..count into
+// sums[(m - 1) * cols ...]; rows advance by step (+1 or -1) from first
+static void partial_sums(const unsigned long *band, int cols, long first, int step, int count,
+                         unsigned long long *sums) {
+    int block = column_block_size(cols, omp_get_max_threads());
+    int num_blocks = (cols + block - 1) / block;
+    
+    #pragma omp parallel for schedule(runtime)
+    for (int cb = 0; cb < num_blocks; cb++) {
+        int col_start = cb * block;
+        int col_end = (col_start + block < cols) ? col_start + block : cols;
+        for (int m = 0; m < count; m++) {
+            const unsigned long *row = &band[(size_t)(first + (long)m * step) * cols];
+            unsigned long long *out = &sums[(size_t)m * cols];
+            const unsigned long long *prev = (m > 0) ? out - cols : NULL;
+            #pragma omp simd
+            for (int c = col_start; c < col_end; c++) {
+                out[c] = ((prev != NULL) ? prev[c] : 0) + row[c];
+            }
+        }
+    }
+}
+
+// Band analysis of one rank; results are complete on rank 0 of comm
+static void band_analysis(MPI_Comm comm, long rows, int cols, unsigned long seed, unsigned long lower,
+                          unsigned long upper, int window_height, int verbose, int work_factor,
+                          unsigned long long *max_sums, int *row_counts, long long *total_hotspots) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+    long r0 = band_row(rows, rank, size);
+    long r1 = band_row(rows, rank + 1, size);
+    long n = r1 - r0;
+    int up_rank = (rank > 0) ? rank - 1 : MPI_PROC_NULL;
+    int down_rank = (rank < size - 1) ? rank + 1 : MPI_PROC_NULL;
+    
+    // Messages count rows, so bands and partial sums never overflow an int count
+    MPI_Datatype grid_row, sums_row;
+    MPI_Type_contiguous(cols, MPI_UNSIGNED_LONG, &grid_row);
+    MPI_Type_contiguous(cols, MPI_UNSIGNED_LONG_LONG, &sums_row);
+    MPI_Type_commit(&grid_row);
+    MPI_Type_commit(&sums_row);
+    
+    // Band with a halo row above and below: local row k is global row r0 + k - 1
+    unsigned long *band = (unsigned long*) malloc((size_t)(n + 2) * cols * sizeof(unsigned long));
+    if (band == NULL) {
+        fail_alloc();
+    }
+    unsigned long *own = &band[cols];
+    
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    #pragma omp parallel for schedule(runtime)
+    for (long i = 0; i < n; i++) {
+        generate_row(&gen, &own[(size_t)i * cols], r0 + i);
+    }
+    row_generator_free(&gen);
+    
+    // Raw grid in row order: rank 0 prints its band, then every other band
+    if (verbose) {
+        if (rank == 0) {
+            printf("A:\n");
+            write_grid_rows(own, 0, n, cols);
+            unsigned long *other = (unsigned long*) malloc((size_t)(rows - n + 1) * cols * sizeof(unsigned long));
+            if (other == NULL) {
+                fail_alloc();
+            }
+            for (int r = 1; r < size; r++) {
+                long count = band_row(rows, r + 1, size) - band_row(rows, r, size);
+                MPI_Recv(other, (int)count, grid_row, r, 0, comm, MPI_STATUS_IGNORE);
+                write_grid_rows(other, 0, count, cols);
+            }
+            printf("\n");
+            free(other);
+        } else {
+            MPI_Send(own, (int)n, grid_row, 0, 0, comm);
+        }
+    }
+    
+    preprocess_heatmap(own, n, cols, work_factor);
+    
+    // One-row halos: first row up / lower halo from below, then last row down / upper halo from above
+    MPI_Sendrecv(own, 1, grid_row, up_rank, 1, &own[(size_t)n * cols], 1, grid_row, down_rank, 1,
+                 comm, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(&own[(size_t)(n - 1) * cols], 1, grid_row, down_rank, 2, band, 1, grid_row, up_rank, 2,
+                 comm, MPI_STATUS_IGNORE);
+    
+    // Part B on the owned rows
+    long long total = 0;
+    #pragma omp parallel for schedule(runtime) reduction(+:total)
+    for (long i = 0; i < n; i++) {
+        const unsigned long *cur = &own[(size_t)i * cols];
+        const unsigned long *up = (r0 + i > 0) ? cur - cols : NULL;
+        const unsigned long *down = (r0 + i < rows - 1) ? cur + cols : NULL;
+        int row_hotspots = hotspots_row(up, cur, down, cols);
+        if (verbose) {
+            row_counts[i] = row_hotspots;
+        }
+        total += row_hotspots;
+    }
+    
+    // Part A, windows inside the band (maxima start at 0, neutral for MAX)
+    unsigned long long *local_max = (unsigned long long*) calloc(cols, sizeof(unsigned long long));
+    if (local_max == NULL) {
+        fail_alloc();
+    }
+    if (n >= window_height) {
+        #pragma omp parallel
+        {
+            window_sums_rows(own, n, cols, window_height, local_max);
+        }
+    }
+    
+    // Part A across the boundary below: top[m - 1] holds the sums of the m
+    // rows starting at r0 (m <= window_height - 1, up to the grid's end),
+    // taking the rest from the next band's top sums when this band is short;
+    // bottom[s - 1] holds the sums of the band's last s rows
+    int halo = window_height - 1;
+    int own_top = (n < halo) ? (int)n : halo;
+    int top_rows = (rows - r0 < halo) ? (int)(rows - r0) : halo;
+    int below_rows = (rows - r1 < halo) ? (int)(rows - r1) : halo;
+    size_t halo_cells = (size_t)(halo > 0 ? halo : 1) * cols;
+    unsigned long long *top = (unsigned long long*) malloc(halo_cells * sizeof(unsigned long long));
+    unsigned long long *bottom = (unsigned long long*) malloc(halo_cells * sizeof(unsigned long long));
+    unsigned long long *below = (unsigned long long*) malloc(halo_cells * sizeof(unsigned long long));
+    if (top == NULL || bottom == NULL || below == NULL) {
+        fail_alloc();
+    }
+    partial_sums(own, cols, 0, 1, own_top, top);
+    partial_sums(own, cols, n - 1, -1, own_top, bottom);
+    
+    // Top sums flow upwards; only a band shorter than the halo waits for its neighbor's first
+    MPI_Request sent = MPI_REQUEST_NULL;
+    int short_band = (top_rows > own_top);
+    if (short_band) {
+        MPI_Recv(below, below_rows, sums_row, down_rank, 3, comm, MPI_STATUS_IGNORE);
+        for (int m = own_top; m < top_rows; m++) {
+            const unsigned long long *rest = &below[(size_t)(m - own_top) * cols];
+            unsigned long long *out = &top[(size_t)m * cols];
+            const unsigned long long *head = &top[(size_t)(own_top - 1) * cols];
+            #pragma omp parallel for simd schedule(static)
+            for (int c = 0; c < cols; c++) {
+                out[c] = head[c] + rest[c];
+            }
+        }
+    }
+    if (halo > 0 && rank > 0) {
+        MPI_Isend(top, top_rows, sums_row, up_rank, 3, comm, &sent);
+    }
+    if (!short_band && halo > 0 && rank < size - 1) {
+        MPI_Recv(below, below_rows, sums_row, down_rank, 3, comm, MPI_STATUS_IGNORE);
+    }
+    
+    // A window starting s rows above r1 takes window_height - s rows from below
+    int first_s = (window_height - below_rows > 1) ? window_height - below_rows : 1;
+    for (int s = first_s; s <= own_top; s++) {
+        const unsigned long long *tail = &bottom[(size_t)(s - 1) * cols];
+        const unsigned long long *rest = &below[(size_t)(window_height - s - 1) * cols];
+        #pragma omp parallel for simd schedule(static)
+        for (int c = 0; c < cols; c++) {
+            unsigned long long sum = tail[c] + rest[c];
+            local_max[c] = (sum > local_max[c]) ? sum : local_max[c];
+        }
+    }
+    MPI_Wait(&sent, MPI_STATUS_IGNORE);
+    
+    // Global results on rank 0
+    MPI_Reduce(local_max, max_sums, cols, MPI_UNSIGNED_LONG_LONG, MPI_MAX, 0, comm);
+    MPI_Reduce(&total, total_hotspots, 1, MPI_LONG_LONG, MPI_SUM, 0, comm);
+    if (verbose) {
+        int *counts = NULL;
+        int *displs = NULL;
+        if (rank == 0) {
+            counts = (int*) malloc(size * sizeof(int));
+            displs = (int*) malloc(size * sizeof(int));
+            if (counts == NULL || displs == NULL) {
+                fail_alloc();
+            }
+            for (int r = 0; r < size; r++) {
+                displs[r] = (int)band_row(rows, r, size);
+                counts[r] = (int)(band_row(rows, r + 1, size) - displs[r]);
+            }
+        }
+        MPI_Gatherv((rank == 0) ? MPI_IN_PLACE : row_counts, (int)n, MPI_INT, row_counts, counts, displs,
+                    MPI_INT, 0, comm);
+        free(displs);
+        free(counts);
+    }
+    
+    free(below);
+    free(bottom);
+    free(top);
+    free(local_max);
+    free(band);
+    MPI_Type_free(&sums_row);
+    MPI_Type_free(&grid_row);
+}
+
+int main(int argc, char *argv[]) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    
+    // Check command-line arguments
+    if (argc != 10) {
+        if (rank == 0) {
+            fprintf(stderr, "Usage: mpirun -np <ranks> %s <columns> <rows> <seed> <lower> <upper> <window_height> <verbose> <num_threads> <work_factor>\n", argv[0]);
+            fprintf(stderr, "       (num_threads OpenMP threads per rank)\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    
+    // Parse command-line arguments
+    int cols = atoi(argv[1]);
+    long rows = strtol(argv[2], NULL, 10);
+    unsigned long seed = strtoul(argv[3], NULL, 10);
+    unsigned long lower = strtoul(argv[4], NULL, 10);
+    unsigned long upper = strtoul(argv[5], NULL, 10);
+    int window_height = atoi(argv[6]);
+    int verbose = atoi(argv[7]);
+    int num_threads = atoi(argv[8]);
+    int work_factor = atoi(argv[9]);
+    
+    // Validate input (the same on every rank, so all of them stop together)
+    if (rows <= 0 || cols <= 0 || window_height <= 0 || window_height > rows || upper <= lower ||
+        num_threads <= 0 || work_factor < 0 || (verbose && rows > 0x7fffffffL)) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: Invalid parameters\n");
+        }
+        MPI_Finalize();
+        return 1;
+    }
+    
+    // Set number of OpenMP threads per rank
+    omp_set_num_threads(num_threads);
+    hash_selected();
+    
+    // Ranks beyond the number of rows get no band
+    MPI_Comm band_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, (rank < rows) ? 0 : MPI_UNDEFINED, rank, &band_comm);
+    if (band_comm == MPI_COMM_NULL) {
+        MPI_Finalize();
+        return 0;
+    }
+    
+    // Print startup message and parameters
+    if (rank == 0) {
+        printf("Starting heatmap_analysis\n");
+        printf("Parameters: columns=%d, rows=%ld, seed=%lu, lower=%lu, upper=%lu, window_height=%d, verbose=%d, num_threads=%d, work_factor=%d\n\n",
+               cols, rows, seed, lower, upper, window_height, verbose, num_threads, work_factor);
+    }
+    
+    // Start timing immediately after reading command-line parameters
+    MPI_Barrier(band_comm);
+    double start_time = MPI_Wtime();
+    
+    // Rank 0 collects the per-row counts of all bands; the others keep their own
+    int band_size;
+    MPI_Comm_size(band_comm, &band_size);
+    long own_rows = band_row(rows, rank + 1, band_size) - band_row(rows, rank, band_size);
+    unsigned long long *max_sums = (unsigned long long*) malloc(cols * sizeof(unsigned long long));
+    int *row_counts = (int*) malloc((verbose ? (rank == 0 ? rows : own_rows) : 1) * sizeof(int));
+    if (max_sums == NULL || row_counts == NULL) {
+        fail_alloc();
+    }
+    long long total_hotspots = 0;
+    
+    band_analysis(band_comm, rows, cols, seed, lower, upper, window_height, verbose, work_factor,
+                  max_sums, row_counts, &total_hotspots);
+    
+    // Output results
+    if (rank == 0) {
+        if (verbose) {
+            // Print maximum sliding sums per column
+            printf("Max sliding sums per column:\n");
+            write_sums(max_sums, cols);
+            printf("\n\n");
+            
+            // Print hotspots per row
+            padded_int *hotspots_per_row = (padded_int*) malloc(rows * sizeof(padded_int));
+            if (hotspots_per_row == NULL) {
+                fail_alloc();
+            }
+            for (long i = 0; i < rows; i++) {
+                hotspots_per_row[i].count = row_counts[i];
+            }
+            printf("Hotspots per row:\n");
+            write_hotspot_counts(hotspots_per_row, rows);
+            printf("\n");
+            free(hotspots_per_row);
+        }
+        
+        printf("Total hotspots found: %lld\n", total_hotspots);
+        
+        // End timing immediately after output (as per speedup measurement spec)
+        double elapsed_time = MPI_Wtime() - start_time;
+        printf("Execution took %.4f s\n", elapsed_time);
+        fprintf(stderr, "Ranks: %d x %d thread(s)\n", band_size, num_threads);
+    }
+    
+    // Clean up
+    free(row_counts);
+    free(max_sums);
+    MPI_Comm_free(&band_comm);
+    MPI_Finalize();
+    
+    return 0;
+}
@@ -0,0 +1,302 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_kernels.h"
+#include "heatmap_numa.h"
+#include "phase_profile.h"
+#include "text_output.h"
+
+// Memory policy constants of <linux/mempolicy.h> (no libnuma needed)
+#define NUMA_MPOL_BIND 2
+#define NUMA_MPOL_F_NODE 1
+#define NUMA_MPOL_F_ADDR 2
+
+#define MAX_NUMA_NODES 64
+
+// Pages per thread whose placement is checked for the locality report
+#define NUMA_SAMPLE_PAGES 1024
+
+static long sys_mbind(void *addr, unsigned long len, int mode, const unsigned long *nodemask,
+                      unsigned long maxnode) {
+#ifdef SYS_mbind
+    return syscall(SYS_mbind, addr, len, mode, nodemask, maxnode, 0);
+#else
+    (void)addr; (void)len; (void)mode; (void)nodemask; (void)maxnode;
+    return -1;
+#endif
+}
+
+static long sys_get_mempolicy(int *node, void *addr) {
+#ifdef SYS_get_mempolicy
+    return syscall(SYS_get_mempolicy, node, NULL, 0, addr, NUMA_MPOL_F_NODE | NUMA_MPOL_F_ADDR);
+#else
+    (void)node; (void)addr;
+    return -1;
+#endif
+}
+
+// Node ids listed in /sys/devices/system/node/online ("0-1,3"); a single
+// node 0 when the file is missing
+static int online_nodes(int *ids) {
+    int n = 0;
+    FILE *in = fopen("/sys/devices/system/node/online", "r");
+    if (in != NULL) {
+        int first, last;
+        char sep;
+        while (fscanf(in, "%d", &first) == 1) {
+            last = first;
+            if (fscanf(in, "%c", &sep) == 1 && sep == '-') {
+                if (fscanf(in, "%d", &last) != 1) {
+                    break;
+                }
+                if (fscanf(in, "%c", &sep) != 1) {
+                    sep = '\n';
+                }
+            }
+            for (int id = first; id <= last && n < MAX_NUMA_NODES; id++) {
+                ids[n++] = id;
+            }
+            if (sep != ',') {
+                break;
+            }
+        }
+        fclose(in);
+    }
+    if (n == 0) {
+        ids[n++] = 0;
+    }
+    return n;
+}
+
+// CPUs of a node (cpulist format) that the process may run on
+static void node_cpus(int node, const cpu_set_t *allowed, cpu_set_t *cpus) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+    CPU_ZERO(cpus);
+    FILE *in = fopen(path, "r");
+    if (in == NULL) {
+        return;
+    }
+    int first, last;
+    char sep = ',';
+    while (sep == ',' && fscanf(in, "%d", &first) == 1) {
+        last = first;
+        if (fscanf(in, "%c", &sep) == 1 && sep == '-') {
+            if (fscanf(in, "%d", &last) != 1 || fscanf(in, "%c", &sep) != 1) {
+                sep = '\n';
+            }
+        }
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, allowed)) {
+                CPU_SET(cpu, cpus);
+            }
+        }
+    }
+    fclose(in);
+}
+
+// First row owned by thread t of num_threads
+static long owner_row(long rows, int t, int num_threads) {
+    return rows * t / num_threads;
+}
+
+void numa_analysis(long rows, int cols, unsigned long seed, unsigned long lower,
+                   unsigned long upper, int work_factor, int window_height, int verbose,
+                   unsigned long long *max_sums, padded_int *hotspots_per_row,
+                   long long *total_hotspots, numa_stats *stats) {
+    int num_threads = omp_get_max_threads();
+    int node_ids[MAX_NUMA_NODES];
+    int num_nodes = online_nodes(node_ids);
+    long page = sysconf(_SC_PAGESIZE);
+    size_t row_bytes = (size_t)cols * sizeof(unsigned long);
+    size_t bytes = (size_t)rows * row_bytes;
+    
+    // Thread t works on node slot t * num_nodes / num_threads
+    int *thread_slot = (int*) malloc(num_threads * sizeof(int));
+    unsigned long long **partials = (unsigned long long**) calloc(num_threads, sizeof(unsigned long long*));
+    cpu_set_t *slot_cpus = (cpu_set_t*) malloc(num_nodes * sizeof(cpu_set_t));
+    if (thread_slot == NULL || partials == NULL || slot_cpus == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    memset(stats, 0, sizeof(*stats));
+    int last_slot = -1;
+    for (int t = 0; t < num_threads; t++) {
+        thread_slot[t] = (int)((long)t * num_nodes / num_threads);
+        if (thread_slot[t] != last_slot) {
+            stats->nodes++;
+            last_slot = thread_slot[t];
+        }
+    }
+    
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    int have_mask = (sched_getaffinity(0, sizeof(allowed), &allowed) == 0);
+    for (int s = 0; s < num_nodes; s++) {
+        CPU_ZERO(&slot_cpus[s]);
+        if (have_mask) {
+            node_cpus(node_ids[s], &allowed, &slot_cpus[s]);
+        }
+    }
+    
+    // Page-aligned mapping; a page belongs to the node that owns its first byte
+    unsigned long *heatmap = (unsigned long*) mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                                                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (heatmap == MAP_FAILED) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    stats->bound = 1;
+    for (int t = 0; t < num_threads && stats->bound; t++) {
+        if (t > 0 && thread_slot[t] == thread_slot[t - 1]) {
+            continue;
+        }
+        int t_end = t;
+        while (t_end < num_threads && thread_slot[t_end] == thread_slot[t]) {
+            t_end++;
+        }
+        size_t begin = owner_row(rows, t, num_threads) * row_bytes;
+        size_t end = owner_row(rows, t_end, num_threads) * row_bytes;
+        begin = (begin + page - 1) / page * page;
+        end = (end + page - 1) / page * page;
+        if (end > begin) {
+            unsigned long mask[MAX_NUMA_NODES / (8 * sizeof(unsigned long)) + 1] = { 0 };
+            int id = node_ids[thread_slot[t]];
+            mask[id / (8 * sizeof(unsigned long))] |= 1UL << (id % (8 * sizeof(unsigned long)));
+            if (sys_mbind((char*)heatmap + begin, end - begin, NUMA_MPOL_BIND, mask,
+                          sizeof(mask) * 8) != 0) {
+                stats->bound = 0;
+            }
+        }
+    }
+    
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    hash_selected();
+    long long total = 0;
+    int pinned = 1;
+    long pages_sampled = 0;
+    long pages_local = 0;
+    
+    if (verbose) {
+        printf("A:\n");
+    }
+    
+    #pragma omp parallel num_threads(num_threads) reduction(+:total, pages_sampled, pages_local)
+    {
+        int t = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        int slot = (int)((long)t * num_nodes / team);
+        long r0 = owner_row(rows, t, team);
+        long r1 = owner_row(rows, t + 1, team);
+        
+        if (CPU_COUNT(&slot_cpus[slot]) == 0 ||
+            sched_setaffinity(0, sizeof(cpu_set_t), &slot_cpus[slot]) != 0) {
+            #pragma omp atomic write
+            pinned = 0;
+        }
+        
+        // Generate (and hash) the owned rows: the owner touches them first
+        profile_enter(PROF_INIT);
+        for (long i = r0; i < r1; i++) {
+            generate_row(&gen, &heatmap[(size_t)i * cols], i);
+            if (!verbose) {
+                hash_row(&heatmap[(size_t)i * cols], cols, work_factor);
+            }
+        }
+        profile_leave(PROF_INIT);
+        #pragma omp barrier
+        
+        if (verbose) {
+            team_write_grid_rows(heatmap, 0, rows, cols);
+            
+            profile_enter(PROF_PREPROCESS);
+            for (long i = r0; i < r1; i++) {
+                hash_row(&heatmap[(size_t)i * cols], cols, work_factor);
+            }
+            profile_leave(PROF_PREPROCESS);
+            #pragma omp barrier
+        }
+        
+        // Locality of the owned rows
+        size_t first_page = (size_t)r0 * row_bytes / page;
+        size_t end_page = ((size_t)r1 * row_bytes + page - 1) / page;
+        size_t step = (end_page - first_page + NUMA_SAMPLE_PAGES - 1) / NUMA_SAMPLE_PAGES;
+        if (step == 0) {
+            step = 1;
+        }
+        for (size_t p = first_page; p < end_page; p += step) {
+            int node;
+            if (sys_get_mempolicy(&node, (char*)heatmap + p * page) != 0) {
+                break;
+            }
+            pages_sampled++;
+            pages_local += (node == node_ids[slot]);
+        }
+        
+        // Part B on the owned rows (the neighbors' boundary rows are read once)
+        profile_enter(PROF_PART_B);
+        for (long i = r0; i < r1; i++) {
+            int row_hotspots = count_row_hotspots(heatmap, rows, cols, i);
+            hotspots_per_row[i].count = row_hotspots;
+            total += row_hotspots;
+        }
+        profile_leave(PROF_PART_B);
+        
+        // Part A: windows starting in the owned rows, with a halo of
+        // window_height - 1 rows below; the partial lives on the owner's node
+        profile_enter(PROF_PART_A);
+        unsigned long long *partial = (unsigned long long*) calloc(cols, sizeof(unsigned long long));
+        if (partial == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        partials[t] = partial;
+        long last_start = (r1 - 1 < rows - window_height) ? r1 - 1 : rows - window_height;
+        for (int col_start = 0; col_start < cols && r0 <= last_start; col_start += PART_A_COL_BLOCK) {
+            int col_end = (col_start + PART_A_COL_BLOCK < cols) ? col_start + PART_A_COL_BLOCK : cols;
+            unsigned long long cur_sums[PART_A_COL_BLOCK] = {0};
+            for (long row = r0; row < last_start + window_height; row++) {
+                const unsigned long *in_row = &heatmap[(size_t)row * cols + col_start];
+                const unsigned long *out_row = (row - r0 >= window_height) ? in_row - (size_t)window_height * cols : NULL;
+                window_sums_step(in_row, out_row, row - r0, window_height, col_end - col_start,
+                                 cur_sums, &partial[col_start]);
+            }
+        }
+        profile_leave(PROF_PART_A);
+        #pragma omp barrier
+        
+        // Merge step: every column takes the maximum over the owners
+        #pragma omp for schedule(static)
+        for (int c = 0; c < cols; c++) {
+            unsigned long long best = 0;
+            for (int k = 0; k < team; k++) {
+                best = (partials[k][c] > best) ? partials[k][c] : best;
+            }
+            max_sums[c] = best;
+        }
+        free(partial);
+    }
+    
+    if (verbose) {
+        printf("\n");
+    }
+    
+    stats->pinned = pinned;
+    stats->pages_sampled = pages_sampled;
+    stats->pages_local = pages_local;
+    *total_hotspots = total;
+    
+    row_generator_free(&gen);
+    munmap(heatmap, bytes);
+    free(slot_cpus);
+    free(partials);
+    free(thread_slot);
+}
@@ -0,0 +1,30 @@
+#ifndef HEATMAP_NUMA_H
+#define HEATMAP_NUMA_H
+
+#include "common.h"
+
+// NUMA-aware pipeline: thread t owns the contiguous rows
+// [rows * t / T, rows * (t + 1) / T) in every phase, threads are pinned to
+// the CPUs of node t * nodes / T, and each node's rows are bound to its
+// memory with mbind() (first touch by the owner when mbind is unavailable).
+// Part A runs on the owned rows too: every thread reduces the windows that
+// start in its rows, reading a halo of window_height - 1 rows below them,
+// and the per-owner maxima are merged per column. Results are identical to
+// the default path.
+
+typedef struct {
+    int nodes;              // memory nodes used
+    int bound;              // 1 when the row partitions were bound with mbind()
+    int pinned;             // 1 when threads were pinned to their node's CPUs
+    long pages_sampled;     // pages whose node get_mempolicy() reported
+    long pages_local;       // ... that are on the owning thread's node
+} numa_stats;
+
+// Prints the "A:" section itself when verbose. The grid is allocated and
+// released internally.
+void numa_analysis(long rows, int cols, unsigned long seed, unsigned long lower,
+                   unsigned long upper, int work_factor, int window_height, int verbose,
+                   unsigned long long *max_sums, padded_int *hotspots_per_row,
+                   long long *total_hotspots, numa_stats *stats);
+
+#endif
@@ -0,0 +1,104 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_quick.h"
+#include "hotspot_kernels.h"
+#include "phase_profile.h"
+
+long quick_scan(unsigned long *heatmap, long rows, int cols, const row_generator *gen,
+                int work_factor, padded_int *hotspots_per_row, long long *total_hotspots) {
+    long long total = 0;
+    long early_exit_row = rows;    // lowest zero row found so far (rows: none)
+    long band = band_rows_for_cache(cols, 1);
+    long num_bands = (rows + band - 1) / band;
+    
+    // Resolve the hash variant once, outside the parallel region
+    hash_selected();
+    
+    #pragma omp parallel
+    {
+        // Halo rows of a band (owned by the neighboring bands) are recomputed
+        // privately, so bands never wait on each other
+        unsigned long *halo_up = (unsigned long*) malloc(cols * sizeof(unsigned long));
+        unsigned long *halo_down = (unsigned long*) malloc(cols * sizeof(unsigned long));
+        if (halo_up == NULL || halo_down == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        
+        // Bands are handed out in ascending order: once a zero row is known,
+        // every band not yet handed out lies below it, so cancelling stops
+        // the dispatch. A band already handed out may still hold a lower zero
+        // row, so it only skips itself via early_exit_row (no cancellation
+        // point in the body). Without OMP_CANCELLATION=true the early_exit_row
+        // checks still stop each thread after its current row.
+        #pragma omp for schedule(dynamic, 1) reduction(+:total)
+        for (long b = 0; b < num_bands; b++) {
+            long band_start = b * band;
+            long band_end = (band_start + band < rows) ? band_start + band : rows;
+            long exit_row;
+            #pragma omp atomic read
+            exit_row = early_exit_row;
+            if (exit_row < band_start) {
+                continue;
+            }
+            
+            // The band's lazy generation and hashing count as part of the scan
+            profile_enter(PROF_PART_B);
+            int found_zero = 0;
+            if (band_start > 0) {
+                generate_row(gen, halo_up, band_start - 1);
+                hash_row(halo_up, cols, work_factor);
+            }
+            unsigned long *next = &heatmap[(size_t)band_start * cols];
+            generate_row(gen, next, band_start);
+            hash_row(next, cols, work_factor);
+            
+            for (long i = band_start; i < band_end; i++) {
+                // Produce row i + 1 before row i can be checked
+                unsigned long *cur = next;
+                next = NULL;
+                if (i + 1 < band_end) {
+                    next = cur + cols;
+                } else if (i + 1 < rows) {
+                    next = halo_down;
+                }
+                if (next != NULL) {
+                    generate_row(gen, next, i + 1);
+                    hash_row(next, cols, work_factor);
+                }
+                
+                const unsigned long *up = (i == 0) ? NULL : (i == band_start ? halo_up : cur - cols);
+                int row_hotspots = hotspots_row(up, cur, next, cols);
+                hotspots_per_row[i].count = row_hotspots;
+                total += row_hotspots;
+                
+                // Check for early exit condition (keep the lowest zero row)
+                if (row_hotspots == 0) {
+                    #pragma omp atomic compare
+                    if (i < early_exit_row) { early_exit_row = i; }
+                    found_zero = 1;
+                    break;
+                }
+                
+                #pragma omp atomic read
+                exit_row = early_exit_row;
+                if (exit_row < i) {
+                    break;
+                }
+            }
+            profile_leave(PROF_PART_B);
+            
+            if (found_zero) {
+                #pragma omp cancel for
+            }
+        }
+        
+        free(halo_up);
+        free(halo_down);
+    }
+    
+    *total_hotspots = total;
+    return (early_exit_row < rows) ? early_exit_row : -1;
+}
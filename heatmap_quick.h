@@ -0,0 +1,15 @@
+#ifndef HEATMAP_QUICK_H
+#define HEATMAP_QUICK_H
+
+#include "common.h"
+#include "heatmap_kernels.h"
+
+// Lazy banded generate/hash/scan of the quick analysis: rows are generated
+// and hashed right before they are scanned and the scan stops at the first
+// row without hotspots. Counts land in hotspots_per_row (rows past the exit
+// row are left untouched) and their sum in total_hotspots. Returns the
+// lowest zero row, or -1 when every row has a hotspot.
+long quick_scan(unsigned long *heatmap, long rows, int cols, const row_generator *gen,
+                int work_factor, padded_int *hotspots_per_row, long long *total_hotspots);
+
+#endif
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "hash_kernels.h"
+#include "heatmap_kernels.h"
+#include "heatmap_stream.h"
+#include "hotspot_kernels.h"
+#include "phase_profile.h"
+#include "text_output.h"
+
+// Ring buffer of grid rows: row r lives in slot r % capacity
+typedef struct {
+    unsigned long *data;
+    long capacity;
+    int cols;
+} row_ring;
+
+static inline unsigned long* ring_row(const row_ring *ring, long row) {
+    return &ring->data[(size_t)(row % ring->capacity) * ring->cols];
+}
+
+// Rows of the current band, for the parallel "A:" output
+typedef struct {
+    const row_ring *ring;
+    long band_start;
+} ring_band;
+
+static size_t render_ring_rows(char *out, long begin, long end, const void *ctx) {
+    const ring_band *band = (const ring_band*)ctx;
+    char *p = out;
+    for (long i = begin; i < end; i++) {
+        p += format_row(p, ring_row(band->ring, band->band_start + i), band->ring->cols);
+    }
+    return p - out;
+}
+
+void stream_analysis(long rows, int cols, unsigned long seed, unsigned long lower,
+                     unsigned long upper, int window_height, int work_factor, int verbose,
+                     unsigned long long *max_sums, padded_int *hotspots_per_row,
+                     long long *total_hotspots) {
+    int band_rows = band_rows_for_cache(cols, omp_get_max_threads());
+    int col_block = column_block_size(cols, omp_get_max_threads());
+    int num_col_blocks = (cols + col_block - 1) / col_block;
+    
+    // A band step reads back window_height rows (outgoing window rows) and
+    // two rows (hotspot halo) behind the band; with single-row bands this is
+    // the minimal window_height + 2 rows
+    row_ring ring;
+    ring.capacity = window_height + 1 + band_rows;
+    ring.cols = cols;
+    ring.data = (unsigned long*) malloc((size_t)ring.capacity * cols * sizeof(unsigned long));
+    unsigned long long *cur_sums = (unsigned long long*) calloc(cols, sizeof(unsigned long long));
+    
+    if (ring.data == NULL || cur_sums == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    
+    long long total = 0;
+    hash_selected();
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    
+    if (verbose) {
+        printf("A:\n");
+    }
+    
+    #pragma omp parallel
+    {
+        for (long band_start = 0; band_start < rows; band_start += band_rows) {
+            long band_end = (band_start + band_rows < rows) ? band_start + band_rows : rows;
+            
+            // Generate and preprocess the band into the ring
+            profile_enter(PROF_INIT);
+            #pragma omp for schedule(runtime) nowait
+            for (long i = band_start; i < band_end; i++) {
+                generate_row(&gen, ring_row(&ring, i), i);
+                if (!verbose) {
+                    hash_row(ring_row(&ring, i), cols, work_factor);
+                }
+            }
+            profile_leave(PROF_INIT);
+            #pragma omp barrier
+            
+            if (verbose) {
+                ring_band band = { &ring, band_start };
+                team_write(band_end - band_start, (size_t)cols * 21, render_ring_rows, &band);
+                
+                profile_enter(PROF_PREPROCESS);
+                #pragma omp for schedule(runtime) nowait
+                for (long i = band_start; i < band_end; i++) {
+                    hash_row(ring_row(&ring, i), cols, work_factor);
+                }
+                profile_leave(PROF_PREPROCESS);
+                #pragma omp barrier
+            }
+            
+            // Part B: the last row of the band waits for the next band's first row
+            long hot_begin = (band_start > 0) ? band_start - 1 : 0;
+            long hot_end = (band_end == rows) ? rows : band_end - 1;
+            profile_enter(PROF_PART_B);
+            #pragma omp for schedule(runtime) reduction(+:total) nowait
+            for (long i = hot_begin; i < hot_end; i++) {
+                const unsigned long *up = (i > 0) ? ring_row(&ring, i - 1) : NULL;
+                const unsigned long *down = (i < rows - 1) ? ring_row(&ring, i + 1) : NULL;
+                int row_hotspots = hotspots_row(up, ring_row(&ring, i), down, cols);
+                if (hotspots_per_row != NULL) {
+                    hotspots_per_row[i].count = row_hotspots;
+                }
+                total += row_hotspots;
+            }
+            profile_leave(PROF_PART_B);
+            
+            // Part A: advance the running window sums of a column block through the band
+            // (the barrier keeps the ring slots alive until every thread is done)
+            profile_enter(PROF_PART_A);
+            #pragma omp for schedule(runtime) nowait
+            for (int cb = 0; cb < num_col_blocks; cb++) {
+                int col_start = cb * col_block;
+                int col_end = (col_start + col_block < cols) ? col_start + col_block : cols;
+                
+                for (long row = band_start; row < band_end; row++) {
+                    const unsigned long *out_row = (row >= window_height) ? ring_row(&ring, row - window_height) + col_start : NULL;
+                    window_sums_step(ring_row(&ring, row) + col_start, out_row, row, window_height,
+                                     col_end - col_start, &cur_sums[col_start], &max_sums[col_start]);
+                }
+            }
+            profile_leave(PROF_PART_A);
+            #pragma omp barrier
+        }
+    }
+    
+    if (verbose) {
+        printf("\n");
+    }
+    
+    *total_hotspots = total;
+    row_generator_free(&gen);
+    free(cur_sums);
+    free(ring.data);
+}
@@ -0,0 +1,16 @@
+#ifndef HEATMAP_STREAM_H
+#define HEATMAP_STREAM_H
+
+#include "common.h"
+
+// Streaming (out-of-core) analysis: rows are generated and preprocessed on
+// the fly into a ring buffer and Part A / Part B are computed incrementally,
+// so peak memory is O((window_height + band) x cols) regardless of rows.
+// Prints the "A:" section itself when verbose. hotspots_per_row may be NULL
+// when per-row counts are not needed.
+void stream_analysis(long rows, int cols, unsigned long seed, unsigned long lower,
+                     unsigned long upper, int window_height, int work_factor, int verbose,
+                     unsigned long long *max_sums, padded_int *hotspots_per_row,
+                     long long *total_hotspots);
+
+#endif
@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "common.h"
+#include "hash_kernels.h"
+#include "heatmap_kernels.h"
+#include "heatmap_tasks.h"
+#include "phase_profile.h"
+#include "text_output.h"
+
+// Phases of the task graph
+enum { PHASE_INIT, PHASE_PRINT, PHASE_PREPROCESS, PHASE_HOTSPOTS, PHASE_PART_A, NUM_PHASES };
+
+static const char *phase_names[NUM_PHASES] = { "init", "print", "preprocess", "hotspots", "partA" };
+
+// Start/end of one task and the critical path ending with it
+typedef struct {
+    double start;
+    double end;
+    double path;        // longest chain of task durations ending here
+    int prev_phase;     // predecessor on that chain (-1 for a source task)
+    long prev_index;
+} task_time;
+
+// Extend the chain of t through predecessor p if that is longer
+static inline void chain(task_time *t, const task_time *p, int phase, long index) {
+    if (p->path > t->path) {
+        t->path = p->path;
+        t->prev_phase = phase;
+        t->prev_index = index;
+    }
+}
+
+void task_analysis(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                   unsigned long lower, unsigned long upper, int work_factor,
+                   int window_height, int verbose, unsigned long long *max_sums,
+                   padded_int *hotspots_per_row, long long *total_hotspots) {
+    // One band per task, sized for one thread's L2 but small enough that
+    // every thread gets several bands
+    int num_threads = omp_get_max_threads();
+    long band_rows = band_rows_for_cache(cols, 1);
+    long min_bands = 4L * num_threads;
+    if ((rows + band_rows - 1) / band_rows < min_bands) {
+        band_rows = (rows + min_bands - 1) / min_bands;
+    }
+    long num_bands = (rows + band_rows - 1) / band_rows;
+    int col_block = column_block_size(cols, 1);
+    int num_col_blocks = (cols + col_block - 1) / col_block;
+    hash_selected();
+    row_generator gen;
+    row_generator_init(&gen, cols, seed, lower, upper);
+    
+    // Window sums accumulate from zero; the totals and sentinels are zeroed too
+    unsigned long long *cur_sums = (unsigned long long*) calloc_or_die(cols * sizeof(unsigned long long));
+    long long *band_totals = (long long*) calloc_or_die(num_bands * sizeof(long long));
+    
+    // Dependency sentinels: band k is band_dep[k + 1] (the padding entries
+    // are never written, so edge bands need no special case); the entry
+    // after the padding orders the verbose prints
+    char *band_dep = (char*) calloc_or_die(num_bands + 3);
+    char *block_dep = (char*) calloc_or_die(num_col_blocks);
+    
+    task_time *times[NUM_PHASES];
+    long phase_tasks[NUM_PHASES] = { num_bands, verbose ? num_bands : 0, num_bands, num_bands,
+                                     num_bands * num_col_blocks };
+    for (int p = 0; p < NUM_PHASES; p++) {
+        times[p] = (task_time*) malloc_or_die((phase_tasks[p] + 1) * sizeof(task_time));
+    }
+    
+    if (verbose) {
+        printf("A:\n");
+    }
+    
+    double graph_start = omp_get_wtime();
+    
+    #pragma omp parallel
+    #pragma omp single
+    {
+        for (long k = 0; k <= num_bands; k++) {
+            long band_start = k * band_rows;
+            long band_end = (band_start + band_rows < rows) ? band_start + band_rows : rows;
+            
+            if (k < num_bands) {
+                #pragma omp task depend(out: band_dep[k + 1])
+                {
+                    times[PHASE_INIT][k].start = omp_get_wtime();
+                    profile_enter(PROF_INIT);
+                    for (long i = band_start; i < band_end; i++) {
+                        generate_row(&gen, &heatmap[(size_t)i * cols], i);
+                    }
+                    profile_leave(PROF_INIT);
+                    times[PHASE_INIT][k].end = omp_get_wtime();
+                }
+                
+                // Raw bands are printed in order before they are hashed
+                if (verbose) {
+                    #pragma omp task depend(in: band_dep[k + 1]) depend(inout: band_dep[num_bands + 2])
+                    {
+                        times[PHASE_PRINT][k].start = omp_get_wtime();
+                        profile_enter(PROF_OUTPUT);
+                        write_grid_rows(heatmap, band_start, band_end, cols);
+                        profile_leave(PROF_OUTPUT);
+                        times[PHASE_PRINT][k].end = omp_get_wtime();
+                    }
+                }
+                
+                #pragma omp task depend(inout: band_dep[k + 1])
+                {
+                    times[PHASE_PREPROCESS][k].start = omp_get_wtime();
+                    profile_enter(PROF_PREPROCESS);
+                    for (long i = band_start; i < band_end; i++) {
+                        hash_row(&heatmap[(size_t)i * cols], cols, work_factor);
+                    }
+                    profile_leave(PROF_PREPROCESS);
+                    times[PHASE_PREPROCESS][k].end = omp_get_wtime();
+                }
+                
+                // Part A: one task per column block, chained through the bands
+                for (int cb = 0; cb < num_col_blocks; cb++) {
+                    #pragma omp task depend(in: band_dep[k + 1]) depend(inout: block_dep[cb])
+                    {
+                        task_time *t = &times[PHASE_PART_A][k * num_col_blocks + cb];
+                        int col_start = cb * col_block;
+                        int col_end = (col_start + col_block < cols) ? col_start + col_block : cols;
+                        t->start = omp_get_wtime();
+                        profile_enter(PROF_PART_A);
+                        window_sums_block(heatmap, cols, band_start, band_end, window_height,
+                                          col_start, col_end, &cur_sums[col_start], &max_sums[col_start]);
+                        profile_leave(PROF_PART_A);
+                        t->end = omp_get_wtime();
+                    }
+                }
+            }
+            
+            // Hotspots of the previous band, now that its lower neighbor exists
+            if (k > 0) {
+                long h = k - 1;
+                #pragma omp task depend(in: band_dep[h], band_dep[h + 1], band_dep[h + 2])
+                {
+                    long hot_start = h * band_rows;
+                    long hot_end = (hot_start + band_rows < rows) ? hot_start + band_rows : rows;
+                    long long total = 0;
+                    times[PHASE_HOTSPOTS][h].start = omp_get_wtime();
+                    profile_enter(PROF_PART_B);
+                    for (long i = hot_start; i < hot_end; i++) {
+                        int row_hotspots = count_row_hotspots(heatmap, rows, cols, i);
+                        hotspots_per_row[i].count = row_hotspots;
+                        total += row_hotspots;
+                    }
+                    band_totals[h] = total;
+                    profile_leave(PROF_PART_B);
+                    times[PHASE_HOTSPOTS][h].end = omp_get_wtime();
+                }
+            }
+        }
+    }
+    
+    double wall = omp_get_wtime() - graph_start;
+    
+    if (verbose) {
+        printf("\n");
+    }
+    
+    long long total = 0;
+    for (long k = 0; k < num_bands; k++) {
+        total += band_totals[k];
+    }
+    *total_hotspots = total;
+    
+    // Critical path: longest chain of task durations along the depend edges,
+    // visited in creation order (every predecessor comes first)
+    for (int p = 0; p < NUM_PHASES; p++) {
+        for (long t = 0; t < phase_tasks[p]; t++) {
+            times[p][t].path = 0.0;
+            times[p][t].prev_phase = -1;
+        }
+    }
+    task_time *end = NULL;
+    int end_phase = -1;
+    long end_index = 0;
+    for (long k = 0; k < num_bands; k++) {
+        task_time *init = &times[PHASE_INIT][k];
+        init->path = init->end - init->start;
+        
+        task_time *hashed = &times[PHASE_PREPROCESS][k];
+        int hash_pred = PHASE_INIT;
+        if (verbose) {
+            task_time *print = &times[PHASE_PRINT][k];
+            chain(print, init, PHASE_INIT, k);
+            if (k > 0) chain(print, &times[PHASE_PRINT][k - 1], PHASE_PRINT, k - 1);
+            print->path += print->end - print->start;
+            hash_pred = PHASE_PRINT;
+        }
+        chain(hashed, &times[hash_pred][k], hash_pred, k);
+        hashed->path += hashed->end - hashed->start;
+        
+        for (int cb = 0; cb < num_col_blocks; cb++) {
+            task_time *t = &times[PHASE_PART_A][k * num_col_blocks + cb];
+            chain(t, hashed, PHASE_PREPROCESS, k);
+            if (k > 0) chain(t, &times[PHASE_PART_A][(k - 1) * num_col_blocks + cb], PHASE_PART_A,
+                             (k - 1) * num_col_blocks + cb);
+            t->path += t->end - t->start;
+            if (end == NULL || t->path > end->path) {
+                end = t;
+                end_phase = PHASE_PART_A;
+                end_index = k * num_col_blocks + cb;
+            }
+        }
+    }
+    for (long k = 0; k < num_bands; k++) {
+        task_time *t = &times[PHASE_HOTSPOTS][k];
+        for (long n = k - 1; n <= k + 1; n++) {
+            if (n >= 0 && n < num_bands) chain(t, &times[PHASE_PREPROCESS][n], PHASE_PREPROCESS, n);
+        }
+        t->path += t->end - t->start;
+        if (t->path > end->path) {
+            end = t;
+            end_phase = PHASE_HOTSPOTS;
+            end_index = k;
+        }
+    }
+    
+    double on_path[NUM_PHASES] = { 0.0 };
+    for (int p = end_phase; p >= 0; ) {
+        task_time *t = &times[p][end_index];
+        on_path[p] += t->end - t->start;
+        p = t->prev_phase;
+        end_index = t->prev_index;
+    }
+    
+    fprintf(stderr, "Task graph: %ld bands of %ld rows, %d column blocks\n", num_bands, band_rows, num_col_blocks);
+    fprintf(stderr, "%-12s %8s %12s %12s %16s\n", "phase", "tasks", "busy (s)", "span (s)", "critical (s)");
+    for (int p = 0; p < NUM_PHASES; p++) {
+        if (phase_tasks[p] == 0) continue;
+        double busy = 0.0;
+        double first = times[p][0].start;
+        double last = times[p][0].end;
+        for (long t = 0; t < phase_tasks[p]; t++) {
+            busy += times[p][t].end - times[p][t].start;
+            if (times[p][t].start < first) first = times[p][t].start;
+            if (times[p][t].end > last) last = times[p][t].end;
+        }
+        fprintf(stderr, "%-12s %8ld %12.6f %12.6f %16.6f\n", phase_names[p], phase_tasks[p],
+                busy, last - first, on_path[p]);
+    }
+    fprintf(stderr, "Critical path %.6f s of %.6f s wall\n", end->path, wall);
+    
+    for (int p = 0; p < NUM_PHASES; p++) {
+        free(times[p]);
+    }
+    row_generator_free(&gen);
+    free(block_dep);
+    free(band_dep);
+    free(band_totals);
+    free(cur_sums);
+}
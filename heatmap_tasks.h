@@ -0,0 +1,18 @@
+#ifndef HEATMAP_TASKS_H
+#define HEATMAP_TASKS_H
+
+#include "common.h"
+
+// Task-graph executor: the grid is split into row bands and every phase of
+// a band (generate, hash, hotspots, window sums per column block) is an
+// OpenMP task ordered only by depend clauses. Hotspots of band k wait for
+// bands k-1..k+1 to be hashed; window sums of a column block chain through
+// the bands in order. There is no global barrier until the end, so phases
+// of different bands overlap. Prints the "A:" section itself when verbose
+// and a per-phase critical-path report to stderr.
+void task_analysis(unsigned long *heatmap, long rows, int cols, unsigned long seed,
+                   unsigned long lower, unsigned long upper, int work_factor,
+                   int window_height, int verbose, unsigned long long *max_sums,
+                   padded_int *hotspots_per_row, long long *total_hotspots);
+
+#endif
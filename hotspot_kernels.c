@@ -0,0 +1,192 @@
+#include <stddef.h>
+#include <immintrin.h>
+#include "cpu_dispatch.h"
+#include "hotspot_kernels.h"
+
+// Hotspot test for a single cell with explicit border checks (used for the
+// peeled first/last column and short tails)
+static inline int hotspot_cell(const unsigned long *up, const unsigned long *cur,
+                               const unsigned long *down, int cols, int j) {
+    unsigned long current = cur[j];
+    return (up == NULL || up[j] < current) &
+           (down == NULL || down[j] < current) &
+           (j == 0 || cur[j - 1] < current) &
+           (j == cols - 1 || cur[j + 1] < current);
+}
+
+int hotspot_at(const unsigned long *up, const unsigned long *cur,
+               const unsigned long *down, int cols, int j) {
+    return hotspot_cell(up, cur, down, cols, j);
+}
+
+// Peeled border columns: j = 0 and j = cols - 1
+static inline int hotspot_border_columns(const unsigned long *up, const unsigned long *cur,
+                                         const unsigned long *down, int cols) {
+    int count = hotspot_cell(up, cur, down, cols, 0);
+    if (cols > 1) {
+        count += hotspot_cell(up, cur, down, cols, cols - 1);
+    }
+    return count;
+}
+
+// Interior columns [1, cols - 1), branchless. has_up/has_down are constants
+// at every call site so each border case gets its own loop.
+static inline __attribute__((always_inline))
+int hotspot_interior_scalar(const unsigned long *up, const unsigned long *cur,
+                            const unsigned long *down, int begin, int end,
+                            int has_up, int has_down) {
+    int count = 0;
+    for (int j = begin; j < end; j++) {
+        unsigned long current = cur[j];
+        int hot = (cur[j - 1] < current) & (cur[j + 1] < current);
+        if (has_up) hot &= up[j] < current;
+        if (has_down) hot &= down[j] < current;
+        count += hot;
+    }
+    return count;
+}
+
+int hotspots_row_scalar(const unsigned long *up, const unsigned long *cur,
+                        const unsigned long *down, int cols) {
+    int count = hotspot_border_columns(up, cur, down, cols);
+    if (up != NULL && down != NULL) {
+        count += hotspot_interior_scalar(up, cur, down, 1, cols - 1, 1, 1);
+    } else if (up != NULL) {
+        count += hotspot_interior_scalar(up, cur, down, 1, cols - 1, 1, 0);
+    } else if (down != NULL) {
+        count += hotspot_interior_scalar(up, cur, down, 1, cols - 1, 0, 1);
+    } else {
+        count += hotspot_interior_scalar(up, cur, down, 1, cols - 1, 0, 0);
+    }
+    return count;
+}
+
+// Branchless compaction: every column index is stored, the cursor only
+// advances past it when the cell is hot
+static inline __attribute__((always_inline))
+int hotspot_indices_interior(const unsigned long *up, const unsigned long *cur,
+                             const unsigned long *down, int cols, int *hot_cols,
+                             int n, int has_up, int has_down) {
+    for (int j = 1; j < cols - 1; j++) {
+        unsigned long current = cur[j];
+        int hot = (cur[j - 1] < current) & (cur[j + 1] < current);
+        if (has_up) hot &= up[j] < current;
+        if (has_down) hot &= down[j] < current;
+        hot_cols[n] = j;
+        n += hot;
+    }
+    return n;
+}
+
+int hotspots_row_indices(const unsigned long *up, const unsigned long *cur,
+                         const unsigned long *down, int cols, int *hot_cols) {
+    hot_cols[0] = 0;
+    int n = hotspot_cell(up, cur, down, cols, 0);
+    if (up != NULL && down != NULL) {
+        n = hotspot_indices_interior(up, cur, down, cols, hot_cols, n, 1, 1);
+    } else if (up != NULL) {
+        n = hotspot_indices_interior(up, cur, down, cols, hot_cols, n, 1, 0);
+    } else if (down != NULL) {
+        n = hotspot_indices_interior(up, cur, down, cols, hot_cols, n, 0, 1);
+    } else {
+        n = hotspot_indices_interior(up, cur, down, cols, hot_cols, n, 0, 0);
+    }
+    if (cols > 1 && hotspot_cell(up, cur, down, cols, cols - 1)) {
+        hot_cols[n++] = cols - 1;
+    }
+    return n;
+}
+
+// AVX2 only has a signed 64-bit compare; flipping the sign bit of both
+// operands turns it into an unsigned one
+__attribute__((target("avx2")))
+static inline __m256i load_biased_avx2(const unsigned long *p) {
+    const __m256i bias = _mm256_set1_epi64x((long long)0x8000000000000000ULL);
+    return _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), bias);
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline int hotspot_interior_avx2(const unsigned long *up, const unsigned long *cur,
+                                        const unsigned long *down, int cols,
+                                        int has_up, int has_down) {
+    int count = 0;
+    int j = 1;
+    for (; j + 4 <= cols - 1; j += 4) {
+        __m256i c = load_biased_avx2(cur + j);
+        __m256i mask = _mm256_and_si256(_mm256_cmpgt_epi64(c, load_biased_avx2(cur + j - 1)),
+                                        _mm256_cmpgt_epi64(c, load_biased_avx2(cur + j + 1)));
+        if (has_up) {
+            mask = _mm256_and_si256(mask, _mm256_cmpgt_epi64(c, load_biased_avx2(up + j)));
+        }
+        if (has_down) {
+            mask = _mm256_and_si256(mask, _mm256_cmpgt_epi64(c, load_biased_avx2(down + j)));
+        }
+        count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(mask)));
+    }
+    return count + hotspot_interior_scalar(up, cur, down, j, cols - 1, has_up, has_down);
+}
+
+__attribute__((target("avx2")))
+int hotspots_row_avx2(const unsigned long *up, const unsigned long *cur,
+                      const unsigned long *down, int cols) {
+    int count = hotspot_border_columns(up, cur, down, cols);
+    if (up != NULL && down != NULL) {
+        count += hotspot_interior_avx2(up, cur, down, cols, 1, 1);
+    } else if (up != NULL) {
+        count += hotspot_interior_avx2(up, cur, down, cols, 1, 0);
+    } else if (down != NULL) {
+        count += hotspot_interior_avx2(up, cur, down, cols, 0, 1);
+    } else {
+        count += hotspot_interior_avx2(up, cur, down, cols, 0, 0);
+    }
+    return count;
+}
+
+// AVX-512 compares unsigned 64-bit lanes directly into a bitmask; the tail
+// of the interior is handled with a masked iteration instead of scalar code
+__attribute__((target("avx512f"), always_inline))
+static inline int hotspot_interior_avx512(const unsigned long *up, const unsigned long *cur,
+                                          const unsigned long *down, int cols,
+                                          int has_up, int has_down) {
+    int count = 0;
+    for (int j = 1; j < cols - 1; j += 8) {
+        __mmask8 lanes = (cols - 1 - j >= 8) ? 0xff : (__mmask8)((1u << (cols - 1 - j)) - 1);
+        __m512i c = _mm512_maskz_loadu_epi64(lanes, cur + j);
+        __mmask8 mask = lanes;
+        mask = _mm512_mask_cmpgt_epu64_mask(mask, c, _mm512_maskz_loadu_epi64(lanes, cur + j - 1));
+        mask = _mm512_mask_cmpgt_epu64_mask(mask, c, _mm512_maskz_loadu_epi64(lanes, cur + j + 1));
+        if (has_up) {
+            mask = _mm512_mask_cmpgt_epu64_mask(mask, c, _mm512_maskz_loadu_epi64(lanes, up + j));
+        }
+        if (has_down) {
+            mask = _mm512_mask_cmpgt_epu64_mask(mask, c, _mm512_maskz_loadu_epi64(lanes, down + j));
+        }
+        count += __builtin_popcount(mask);
+    }
+    return count;
+}
+
+__attribute__((target("avx512f")))
+int hotspots_row_avx512(const unsigned long *up, const unsigned long *cur,
+                        const unsigned long *down, int cols) {
+    int count = hotspot_border_columns(up, cur, down, cols);
+    if (up != NULL && down != NULL) {
+        count += hotspot_interior_avx512(up, cur, down, cols, 1, 1);
+    } else if (up != NULL) {
+        count += hotspot_interior_avx512(up, cur, down, cols, 1, 0);
+    } else if (down != NULL) {
+        count += hotspot_interior_avx512(up, cur, down, cols, 0, 1);
+    } else {
+        count += hotspot_interior_avx512(up, cur, down, cols, 0, 0);
+    }
+    return count;
+}
+
+int hotspots_row(const unsigned long *up, const unsigned long *cur,
+                 const unsigned long *down, int cols) {
+    switch (cpu_detect_isa()) {
+        case ISA_AVX512: return hotspots_row_avx512(up, cur, down, cols);
+        case ISA_AVX2:   return hotspots_row_avx2(up, cur, down, cols);
+        default:         return hotspots_row_scalar(up, cur, down, cols);
+    }
+}
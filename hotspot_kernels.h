@@ -0,0 +1,31 @@
+#ifndef HOTSPOT_KERNELS_H
+#define HOTSPOT_KERNELS_H
+
+// Counts the local hotspots of one row: cells strictly greater than all of
+// their existing 4 neighbors. up/down are the neighboring rows, NULL for the
+// first/last row of the grid.
+typedef int (*hotspot_row_fn)(const unsigned long *up, const unsigned long *cur,
+                              const unsigned long *down, int cols);
+
+// Count hotspots of a row with the widest variant the CPU supports
+int hotspots_row(const unsigned long *up, const unsigned long *cur,
+                 const unsigned long *down, int cols);
+
+// Individual variants (the SIMD ones require the matching CPU support)
+int hotspots_row_scalar(const unsigned long *up, const unsigned long *cur,
+                        const unsigned long *down, int cols);
+int hotspots_row_avx2(const unsigned long *up, const unsigned long *cur,
+                      const unsigned long *down, int cols);
+int hotspots_row_avx512(const unsigned long *up, const unsigned long *cur,
+                        const unsigned long *down, int cols);
+
+// Hotspot test for the single cell j of a row
+int hotspot_at(const unsigned long *up, const unsigned long *cur,
+               const unsigned long *down, int cols, int j);
+
+// Write the column indices of the hotspots of a row, in ascending order, to
+// hot_cols (room for cols entries); returns how many were written
+int hotspots_row_indices(const unsigned long *up, const unsigned long *cur,
+                         const unsigned long *down, int cols, int *hot_cols);
+
+#endif
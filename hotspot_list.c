@@ -0,0 +1,212 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "common.h"
+#include "hotspot_kernels.h"
+#include "hotspot_list.h"
+
+// Hotspots per buffer chunk (buffers grow chunk by chunk, never by copying)
+#define HOTSPOT_CHUNK 4096
+
+typedef struct hotspot_chunk {
+    struct hotspot_chunk *next;
+    long count;
+    hotspot items[HOTSPOT_CHUNK];
+} hotspot_chunk;
+
+// Per-thread state, one cache line apart to avoid false sharing
+typedef struct {
+    hotspot_chunk *head;
+    hotspot_chunk *tail;
+    long count;
+    hotspot *heap;          // min-heap of the best top_k seen, worst at the root
+    int heap_size;
+} __attribute__((aligned(CACHE_LINE_SIZE))) hotspot_buffer;
+
+// aligned_alloc() on whole cache lines that exits on failure (contents undefined)
+static void* aligned_alloc_or_die(size_t size) {
+    void *p = aligned_alloc(CACHE_LINE_SIZE, (size + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE);
+    if (p == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    return p;
+}
+
+static void buffer_push(hotspot_buffer *buf, long row, int col, unsigned long value) {
+    if (buf->tail == NULL || buf->tail->count == HOTSPOT_CHUNK) {
+        hotspot_chunk *chunk = (hotspot_chunk*) aligned_alloc_or_die(sizeof(hotspot_chunk));
+        chunk->next = NULL;
+        chunk->count = 0;
+        if (buf->tail != NULL) {
+            buf->tail->next = chunk;
+        } else {
+            buf->head = chunk;
+        }
+        buf->tail = chunk;
+    }
+    hotspot *h = &buf->tail->items[buf->tail->count++];
+    h->row = row;
+    h->col = col;
+    h->value = value;
+    buf->count++;
+}
+
+// Ranking order: higher value first, then smaller row, then smaller column
+static inline int ranks_before(const hotspot *a, const hotspot *b) {
+    if (a->value != b->value) return a->value > b->value;
+    if (a->row != b->row) return a->row < b->row;
+    return a->col < b->col;
+}
+
+static int compare_rank(const void *a, const void *b) {
+    const hotspot *x = (const hotspot*)a;
+    const hotspot *y = (const hotspot*)b;
+    return ranks_before(x, y) ? -1 : (ranks_before(y, x) ? 1 : 0);
+}
+
+static void heap_sift_down(hotspot *heap, int size, int i) {
+    for (;;) {
+        int worst = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        if (left < size && ranks_before(&heap[worst], &heap[left])) worst = left;
+        if (right < size && ranks_before(&heap[worst], &heap[right])) worst = right;
+        if (worst == i) return;
+        hotspot tmp = heap[i];
+        heap[i] = heap[worst];
+        heap[worst] = tmp;
+        i = worst;
+    }
+}
+
+static void heap_offer(hotspot_buffer *buf, int top_k, long row, int col, unsigned long value) {
+    hotspot h = { row, col, value };
+    if (buf->heap_size < top_k) {
+        // Sift up: the root keeps the worst kept hotspot
+        int i = buf->heap_size++;
+        while (i > 0 && ranks_before(&buf->heap[(i - 1) / 2], &h)) {
+            buf->heap[i] = buf->heap[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        buf->heap[i] = h;
+    } else if (ranks_before(&h, &buf->heap[0])) {
+        buf->heap[0] = h;
+        heap_sift_down(buf->heap, top_k, 0);
+    }
+}
+
+void collect_hotspots(const unsigned long *heatmap, long rows, int cols, int want_list,
+                      int top_k, hotspot_report *report) {
+    int num_threads = omp_get_max_threads();
+    hotspot_buffer *buffers = (hotspot_buffer*) aligned_alloc_or_die(num_threads * sizeof(hotspot_buffer));
+    memset(buffers, 0, num_threads * sizeof(hotspot_buffer));
+    long *offsets = (long*) aligned_alloc_or_die((num_threads + 1) * sizeof(long));
+    
+    memset(report, 0, sizeof(*report));
+    
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int thread_id = omp_get_thread_num();
+        hotspot_buffer *buf = &buffers[thread_id];
+        int *hot_cols = (int*) aligned_alloc_or_die(cols * sizeof(int));
+        if (top_k > 0) {
+            buf->heap = (hotspot*) aligned_alloc_or_die((size_t)top_k * sizeof(hotspot));
+        }
+        
+        // Static contiguous row ranges in thread order keep the concatenation sorted
+        #pragma omp for schedule(static)
+        for (long i = 0; i < rows; i++) {
+            const unsigned long *cur = &heatmap[(size_t)i * cols];
+            const unsigned long *up = (i > 0) ? cur - cols : NULL;
+            const unsigned long *down = (i < rows - 1) ? cur + cols : NULL;
+            int n = hotspots_row_indices(up, cur, down, cols, hot_cols);
+            
+            for (int k = 0; k < n; k++) {
+                if (want_list) {
+                    buffer_push(buf, i, hot_cols[k], cur[hot_cols[k]]);
+                }
+                if (top_k > 0) {
+                    heap_offer(buf, top_k, i, hot_cols[k], cur[hot_cols[k]]);
+                }
+            }
+        }
+        free(hot_cols);
+        
+        // Compaction: exclusive prefix of the per-thread counts gives each
+        // thread its slice of the output array
+        #pragma omp single
+        {
+            offsets[0] = 0;
+            for (int t = 0; t < omp_get_num_threads(); t++) {
+                offsets[t + 1] = offsets[t] + buffers[t].count;
+            }
+            report->count = offsets[omp_get_num_threads()];
+            if (want_list && report->count > 0) {
+                report->list = (hotspot*) malloc(report->count * sizeof(hotspot));
+                if (report->list == NULL) {
+                    fprintf(stderr, "Error: Memory allocation failed\n");
+                    exit(1);
+                }
+            }
+        }
+        
+        long pos = offsets[thread_id];
+        hotspot_chunk *chunk = buf->head;
+        while (chunk != NULL) {
+            hotspot_chunk *next = chunk->next;
+            memcpy(&report->list[pos], chunk->items, chunk->count * sizeof(hotspot));
+            pos += chunk->count;
+            free(chunk);
+            chunk = next;
+        }
+    }
+    
+    // Merge the per-thread heaps (at most num_threads * top_k candidates)
+    if (top_k > 0) {
+        long candidates = 0;
+        for (int t = 0; t < num_threads; t++) {
+            candidates += buffers[t].heap_size;
+        }
+        hotspot *merged = (hotspot*) malloc((candidates > 0 ? candidates : 1) * sizeof(hotspot));
+        if (merged == NULL) {
+            fprintf(stderr, "Error: Memory allocation failed\n");
+            exit(1);
+        }
+        long n = 0;
+        for (int t = 0; t < num_threads; t++) {
+            memcpy(&merged[n], buffers[t].heap, buffers[t].heap_size * sizeof(hotspot));
+            n += buffers[t].heap_size;
+            free(buffers[t].heap);
+        }
+        qsort(merged, n, sizeof(hotspot), compare_rank);
+        report->top = merged;
+        report->top_count = (n < top_k) ? (int)n : top_k;
+    }
+    
+    free(offsets);
+    free(buffers);
+}
+
+void hotspot_report_free(hotspot_report *report) {
+    free(report->list);
+    free(report->top);
+    memset(report, 0, sizeof(*report));
+}
+
+int write_hotspot_list(const char *path, const hotspot_report *report) {
+    FILE *out = fopen(path, "w");
+    if (out == NULL) {
+        fprintf(stderr, "Error: Cannot create %s\n", path);
+        return -1;
+    }
+    for (long k = 0; k < report->count; k++) {
+        fprintf(out, "%ld,%d,%lu\n", report->list[k].row, report->list[k].col, report->list[k].value);
+    }
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Error: Cannot write %s\n", path);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,32 @@
+#ifndef HOTSPOT_LIST_H
+#define HOTSPOT_LIST_H
+
+// Hotspot coordinate extraction and top-K ranking
+
+typedef struct {
+    long row;
+    int col;
+    unsigned long value;
+} hotspot;
+
+typedef struct {
+    hotspot *list;          // all hotspots sorted by (row, col), NULL unless requested
+    long count;             // number of hotspots in list
+    hotspot *top;           // the top_k hottest, by value (ties: row, then column)
+    int top_count;          // min(top_k, total hotspots)
+} hotspot_report;
+
+// Collect hotspot coordinates (want_list) and/or the top_k hottest ones.
+// Threads scan contiguous row ranges into private cache-aligned chunked
+// buffers and private heaps; the buffers are compacted into one sorted
+// array through prefix offsets, the heaps are merged at the end.
+void collect_hotspots(const unsigned long *heatmap, long rows, int cols, int want_list,
+                      int top_k, hotspot_report *report);
+
+// Release the arrays of a report
+void hotspot_report_free(hotspot_report *report);
+
+// Write the list as "row,col,value" lines; returns 0 or -1 after an error
+int write_hotspot_list(const char *path, const hotspot_report *report);
+
+#endif
@@ -0,0 +1,272 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <omp.h>
+#include "common.h"
+#include "phase_profile.h"
+
+#define NUM_COUNTERS 3
+
+static const char *phase_names[NUM_PROFILE_PHASES] = {
+    "init", "preprocess", "partA", "partB", "output", "pi_task"
+};
+
+static const char *counter_names[NUM_COUNTERS] = { "cycles", "instructions", "llc_misses" };
+
+static const uint64_t counter_configs[NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+};
+
+// One thread's share of one phase
+typedef struct {
+    double first_enter;
+    double last_leave;
+    double busy;
+    double entered_at;
+    int depth;
+    int used;
+    uint64_t counters[NUM_COUNTERS];
+    uint64_t counters_at[NUM_COUNTERS];
+} phase_record;
+
+// Per-thread state, one cache line apart to avoid false sharing
+typedef struct {
+    phase_record phases[NUM_PROFILE_PHASES];
+    int counter_fd;         // group leader, -1 if unavailable, -2 if not opened yet
+    int member_fds[NUM_COUNTERS - 1];
+} __attribute__((aligned(CACHE_LINE_SIZE))) thread_profile;
+
+int profile_enabled = 0;
+
+static const char *program_name;
+static int csv_format;
+static int num_threads;
+static int counters_available = 1;
+static thread_profile *threads;
+
+void profile_init(const char *program) {
+    const char *format = getenv("PHASE_PROFILE");
+    if (format == NULL || (strcmp(format, "json") != 0 && strcmp(format, "csv") != 0)) {
+        return;
+    }
+    program_name = program;
+    csv_format = (strcmp(format, "csv") == 0);
+    num_threads = omp_get_max_threads();
+    threads = (thread_profile*) aligned_alloc(CACHE_LINE_SIZE, num_threads * sizeof(thread_profile));
+    if (threads == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    memset(threads, 0, num_threads * sizeof(thread_profile));
+    for (int t = 0; t < num_threads; t++) {
+        threads[t].counter_fd = -2;
+    }
+    profile_enabled = 1;
+}
+
+// Open cycles/instructions/LLC misses of the calling thread as one group
+// (user space only, which perf_event_paranoid <= 2 allows)
+static int open_counters(thread_profile *tp) {
+    int leader = -1;
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = counter_configs[c];
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP;
+        int fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd < 0) {
+            for (int k = 0; k < c - 1; k++) close(tp->member_fds[k]);
+            if (leader >= 0) close(leader);
+            return -1;
+        }
+        if (leader < 0) {
+            leader = fd;
+        } else {
+            tp->member_fds[c - 1] = fd;
+        }
+    }
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return leader;
+}
+
+static void read_counters(thread_profile *tp, uint64_t *values) {
+    uint64_t buffer[1 + NUM_COUNTERS];
+    if (tp->counter_fd < 0 || read(tp->counter_fd, buffer, sizeof(buffer)) != (ssize_t)sizeof(buffer)) {
+        memset(values, 0, NUM_COUNTERS * sizeof(uint64_t));
+        return;
+    }
+    memcpy(values, &buffer[1], NUM_COUNTERS * sizeof(uint64_t));
+}
+
+void profile_enter_slow(profile_phase phase) {
+    int thread_id = omp_get_thread_num();
+    if (thread_id >= num_threads) return;
+    thread_profile *tp = &threads[thread_id];
+    phase_record *rec = &tp->phases[phase];
+    if (rec->depth++ > 0) return;
+    
+    if (tp->counter_fd == -2) {
+        tp->counter_fd = open_counters(tp);
+        if (tp->counter_fd < 0) {
+            #pragma omp atomic write
+            counters_available = 0;
+        }
+    }
+    read_counters(tp, rec->counters_at);
+    rec->entered_at = omp_get_wtime();
+    if (!rec->used) {
+        rec->first_enter = rec->entered_at;
+        rec->used = 1;
+    }
+}
+
+void profile_leave_slow(profile_phase phase) {
+    int thread_id = omp_get_thread_num();
+    if (thread_id >= num_threads) return;
+    thread_profile *tp = &threads[thread_id];
+    phase_record *rec = &tp->phases[phase];
+    if (--rec->depth > 0) return;
+    
+    double now = omp_get_wtime();
+    rec->busy += now - rec->entered_at;
+    rec->last_leave = now;
+    uint64_t values[NUM_COUNTERS];
+    read_counters(tp, values);
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        rec->counters[c] += values[c] - rec->counters_at[c];
+    }
+}
+
+// Aggregate of one phase over all threads
+typedef struct {
+    double wall;
+    double busy_max;
+    double busy_mean;
+    double imbalance;       // max busy / mean busy - 1
+    uint64_t counters[NUM_COUNTERS];
+} phase_summary;
+
+static int summarize(profile_phase phase, phase_summary *s) {
+    double first = 0.0, last = 0.0, busy_total = 0.0;
+    int used = 0;
+    memset(s, 0, sizeof(*s));
+    for (int t = 0; t < num_threads; t++) {
+        const phase_record *rec = &threads[t].phases[phase];
+        if (!rec->used) continue;
+        if (!used || rec->first_enter < first) first = rec->first_enter;
+        if (!used || rec->last_leave > last) last = rec->last_leave;
+        used = 1;
+        busy_total += rec->busy;
+        if (rec->busy > s->busy_max) s->busy_max = rec->busy;
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            s->counters[c] += rec->counters[c];
+        }
+    }
+    if (!used) return 0;
+    s->wall = last - first;
+    s->busy_mean = busy_total / num_threads;
+    s->imbalance = (s->busy_mean > 0.0) ? s->busy_max / s->busy_mean - 1.0 : 0.0;
+    return 1;
+}
+
+static void report_json(FILE *out) {
+    fprintf(out, "{\"program\":\"%s\",\"threads\":%d,\"counters\":%s,\"phases\":[",
+            program_name, num_threads, counters_available ? "true" : "false");
+    int first_phase = 1;
+    for (int p = 0; p < NUM_PROFILE_PHASES; p++) {
+        phase_summary s;
+        if (!summarize((profile_phase)p, &s)) continue;
+        fprintf(out, "%s\n {\"name\":\"%s\",\"wall\":%.9f,\"busy_max\":%.9f,\"busy_mean\":%.9f,\"imbalance\":%.6f",
+                first_phase ? "" : ",", phase_names[p], s.wall, s.busy_max, s.busy_mean, s.imbalance);
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            if (counters_available) {
+                fprintf(out, ",\"%s\":%llu", counter_names[c], (unsigned long long)s.counters[c]);
+            } else {
+                fprintf(out, ",\"%s\":null", counter_names[c]);
+            }
+        }
+        fprintf(out, ",\"per_thread\":[");
+        for (int t = 0; t < num_threads; t++) {
+            double busy = threads[t].phases[p].busy;
+            fprintf(out, "%s{\"thread\":%d,\"busy\":%.9f,\"idle\":%.9f}", t ? "," : "", t, busy, s.wall - busy);
+        }
+        fprintf(out, "]}");
+        first_phase = 0;
+    }
+    fprintf(out, "\n]}\n");
+}
+
+static void report_csv(FILE *out) {
+    fprintf(out, "program,phase,thread,wall_s,busy_s,idle_s,imbalance");
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        fprintf(out, ",%s", counter_names[c]);
+    }
+    fprintf(out, "\n");
+    for (int p = 0; p < NUM_PROFILE_PHASES; p++) {
+        phase_summary s;
+        if (!summarize((profile_phase)p, &s)) continue;
+        // One row per thread, then the aggregate ("all", busy = max)
+        for (int t = 0; t <= num_threads; t++) {
+            const phase_record *rec = (t < num_threads) ? &threads[t].phases[p] : NULL;
+            double busy = rec ? rec->busy : s.busy_max;
+            if (rec) {
+                fprintf(out, "%s,%s,%d,", program_name, phase_names[p], t);
+            } else {
+                fprintf(out, "%s,%s,all,", program_name, phase_names[p]);
+            }
+            fprintf(out, "%.9f,%.9f,%.9f,%.6f", s.wall, busy, s.wall - busy, s.imbalance);
+            for (int c = 0; c < NUM_COUNTERS; c++) {
+                if (counters_available) {
+                    fprintf(out, ",%llu", (unsigned long long)(rec ? rec->counters[c] : s.counters[c]));
+                } else {
+                    fprintf(out, ",");
+                }
+            }
+            fprintf(out, "\n");
+        }
+    }
+}
+
+void profile_report(void) {
+    if (!profile_enabled) {
+        return;
+    }
+    
+    const char *path = getenv("PHASE_PROFILE_FILE");
+    FILE *out = stderr;
+    if (path != NULL && *path != '\0') {
+        out = fopen(path, "w");
+        if (out == NULL) {
+            fprintf(stderr, "Error: Cannot create %s\n", path);
+            out = stderr;
+        }
+    }
+    
+    if (csv_format) {
+        report_csv(out);
+    } else {
+        report_json(out);
+    }
+    
+    if (out != stderr) {
+        fclose(out);
+    }
+    for (int t = 0; t < num_threads; t++) {
+        if (threads[t].counter_fd >= 0) {
+            for (int k = 0; k < NUM_COUNTERS - 1; k++) close(threads[t].member_fds[k]);
+            close(threads[t].counter_fd);
+        }
+    }
+    free(threads);
+    threads = NULL;
+    profile_enabled = 0;
+}
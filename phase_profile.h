@@ -0,0 +1,45 @@
+#ifndef PHASE_PROFILE_H
+#define PHASE_PROFILE_H
+
+// Per-phase instrumentation, enabled at run time with
+//   PHASE_PROFILE=json|csv      report format (unset: disabled)
+//   PHASE_PROFILE_FILE=path     report destination (default stderr)
+// Every thread brackets its share of a phase (worksharing loop or task)
+// with profile_enter()/profile_leave(); the report gives per-phase wall
+// time, per-thread busy and idle time, load imbalance and, where
+// perf_event_open() is permitted, cycles, instructions and LLC misses.
+// When disabled each bracket costs one predictable branch.
+
+typedef enum {
+    PROF_INIT,
+    PROF_PREPROCESS,
+    PROF_PART_A,
+    PROF_PART_B,
+    PROF_OUTPUT,
+    PROF_PI_TASK,
+    NUM_PROFILE_PHASES
+} profile_phase;
+
+extern int profile_enabled;
+
+// Read the environment and size the per-thread records for
+// omp_get_max_threads() threads; call after omp_set_num_threads()
+void profile_init(const char *program);
+
+void profile_enter_slow(profile_phase phase);
+void profile_leave_slow(profile_phase phase);
+
+// Nested brackets of the same phase on one thread (e.g. an undeferred task
+// inside a task) only count once
+static inline void profile_enter(profile_phase phase) {
+    if (profile_enabled) profile_enter_slow(phase);
+}
+
+static inline void profile_leave(profile_phase phase) {
+    if (profile_enabled) profile_leave_slow(phase);
+}
+
+// Write the report (no-op when disabled) and release the counters
+void profile_report(void);
+
+#endif
@@ -0,0 +1,218 @@
+#include <string.h>
+#include <immintrin.h>
+#include "cpu_dispatch.h"
+#include "pi_compute.h"
+
+// Independent vector accumulators kept in flight by the SIMD variants
+#define PI_SIMD_UNROLL 4
+
+static pi_variant selected = PI_AUTO;
+
+// Riemann sum (midpoint rule) over the samples [begin, end)
+double pi_sum_scalar(unsigned long precision, unsigned long begin, unsigned long end) {
+    double sum = 0.0;
+    double step = 1.0 / (double)precision;
+    double half_step = 0.5 * step;
+    
+    // Optimized: precompute half_step, reduce operations per iteration
+    #pragma omp simd reduction(+:sum)
+    for (unsigned long i = begin; i < end; i++) {
+        double x = i * step + half_step;
+        double x_sq = x * x;
+        sum += 4.0 / (1.0 + x_sq);
+    }
+    
+    return sum;
+}
+
+// The SIMD variants sum 1 / (1 + x^2) and scale by 4 once at the end (which
+// is exact). The sample index is kept as a double vector and
+// advanced by one addition per vector, which is exact below 2^53, so
+// x = index * step + half_step is a single FMA without an integer
+// conversion and without the drift of adding step to x repeatedly.
+
+// Remaining samples [i, end) one at a time
+static double pi_tail(unsigned long i, unsigned long end, double step, double half_step) {
+    double sum = 0.0;
+    for (; i < end; i++) {
+        double x = i * step + half_step;
+        sum += 1.0 / (1.0 + x * x);
+    }
+    return sum;
+}
+
+// 1 / d for d in [1, 2]: exact division, or the 12-bit single precision
+// estimate refined by three Newton steps (about 24, 48, then 53 bits)
+__attribute__((target("avx2,fma"))) static inline __attribute__((always_inline))
+__m256d recip_avx2(__m256d d, const int newton) {
+    const __m256d one = _mm256_set1_pd(1.0);
+    if (!newton) {
+        return _mm256_div_pd(one, d);
+    }
+    __m256d r = _mm256_cvtps_pd(_mm_rcp_ps(_mm256_cvtpd_ps(d)));
+    for (int k = 0; k < 3; k++) {
+        __m256d e = _mm256_fnmadd_pd(d, r, one);
+        r = _mm256_fmadd_pd(r, e, r);
+    }
+    return r;
+}
+
+__attribute__((target("avx2,fma"))) static inline __attribute__((always_inline))
+double pi_avx2_body(unsigned long precision, unsigned long begin, unsigned long end, const int newton) {
+    double step = 1.0 / (double)precision;
+    double half_step = 0.5 * step;
+    const __m256d vstep = _mm256_set1_pd(step);
+    const __m256d vhalf = _mm256_set1_pd(half_step);
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d advance = _mm256_set1_pd(4.0 * PI_SIMD_UNROLL);
+    
+    __m256d index[PI_SIMD_UNROLL];
+    __m256d acc[PI_SIMD_UNROLL];
+    for (int u = 0; u < PI_SIMD_UNROLL; u++) {
+        index[u] = _mm256_add_pd(_mm256_set1_pd((double)begin), _mm256_setr_pd(4 * u, 4 * u + 1, 4 * u + 2, 4 * u + 3));
+        acc[u] = _mm256_setzero_pd();
+    }
+    
+    unsigned long i = begin;
+    for (; i + 4 * PI_SIMD_UNROLL <= end; i += 4 * PI_SIMD_UNROLL) {
+        #pragma GCC unroll 4
+        for (int u = 0; u < PI_SIMD_UNROLL; u++) {
+            __m256d x = _mm256_fmadd_pd(index[u], vstep, vhalf);
+            __m256d d = _mm256_fmadd_pd(x, x, one);
+            acc[u] = _mm256_add_pd(acc[u], recip_avx2(d, newton));
+            index[u] = _mm256_add_pd(index[u], advance);
+        }
+    }
+    
+    __m256d total = _mm256_add_pd(_mm256_add_pd(acc[0], acc[1]), _mm256_add_pd(acc[2], acc[3]));
+    double lanes[4];
+    _mm256_storeu_pd(lanes, total);
+    double sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+    sum += pi_tail(i, end, step, half_step);
+    return 4.0 * sum;
+}
+
+__attribute__((target("avx2,fma")))
+double pi_sum_avx2(unsigned long precision, unsigned long begin, unsigned long end) {
+    return pi_avx2_body(precision, begin, end, 0);
+}
+
+__attribute__((target("avx2,fma")))
+double pi_sum_avx2_newton(unsigned long precision, unsigned long begin, unsigned long end) {
+    return pi_avx2_body(precision, begin, end, 1);
+}
+
+// 1 / d for d in [1, 2]: exact division, or the 14-bit estimate refined by
+// two Newton steps (about 28, then 53 bits)
+__attribute__((target("avx512f"))) static inline __attribute__((always_inline))
+__m512d recip_avx512(__m512d d, const int newton) {
+    const __m512d one = _mm512_set1_pd(1.0);
+    if (!newton) {
+        return _mm512_div_pd(one, d);
+    }
+    __m512d r = _mm512_rcp14_pd(d);
+    for (int k = 0; k < 2; k++) {
+        __m512d e = _mm512_fnmadd_pd(d, r, one);
+        r = _mm512_fmadd_pd(r, e, r);
+    }
+    return r;
+}
+
+__attribute__((target("avx512f"))) static inline __attribute__((always_inline))
+double pi_avx512_body(unsigned long precision, unsigned long begin, unsigned long end, const int newton) {
+    double step = 1.0 / (double)precision;
+    double half_step = 0.5 * step;
+    const __m512d vstep = _mm512_set1_pd(step);
+    const __m512d vhalf = _mm512_set1_pd(half_step);
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d advance = _mm512_set1_pd(8.0 * PI_SIMD_UNROLL);
+    
+    __m512d index[PI_SIMD_UNROLL];
+    __m512d acc[PI_SIMD_UNROLL];
+    for (int u = 0; u < PI_SIMD_UNROLL; u++) {
+        index[u] = _mm512_add_pd(_mm512_set1_pd((double)begin),
+                                 _mm512_setr_pd(8 * u, 8 * u + 1, 8 * u + 2, 8 * u + 3,
+                                                8 * u + 4, 8 * u + 5, 8 * u + 6, 8 * u + 7));
+        acc[u] = _mm512_setzero_pd();
+    }
+    
+    unsigned long i = begin;
+    for (; i + 8 * PI_SIMD_UNROLL <= end; i += 8 * PI_SIMD_UNROLL) {
+        #pragma GCC unroll 4
+        for (int u = 0; u < PI_SIMD_UNROLL; u++) {
+            __m512d x = _mm512_fmadd_pd(index[u], vstep, vhalf);
+            __m512d d = _mm512_fmadd_pd(x, x, one);
+            acc[u] = _mm512_add_pd(acc[u], recip_avx512(d, newton));
+            index[u] = _mm512_add_pd(index[u], advance);
+        }
+    }
+    
+    __m512d total = _mm512_add_pd(_mm512_add_pd(acc[0], acc[1]), _mm512_add_pd(acc[2], acc[3]));
+    double sum = _mm512_reduce_add_pd(total);
+    sum += pi_tail(i, end, step, half_step);
+    return 4.0 * sum;
+}
+
+__attribute__((target("avx512f")))
+double pi_sum_avx512(unsigned long precision, unsigned long begin, unsigned long end) {
+    return pi_avx512_body(precision, begin, end, 0);
+}
+
+__attribute__((target("avx512f")))
+double pi_sum_avx512_newton(unsigned long precision, unsigned long begin, unsigned long end) {
+    return pi_avx512_body(precision, begin, end, 1);
+}
+
+static const pi_sum_fn kernels[PI_AVX512_NEWTON + 1] = {
+    [PI_SCALAR] = pi_sum_scalar,
+    [PI_AVX2] = pi_sum_avx2,
+    [PI_AVX2_NEWTON] = pi_sum_avx2_newton,
+    [PI_AVX512] = pi_sum_avx512,
+    [PI_AVX512_NEWTON] = pi_sum_avx512_newton
+};
+
+pi_sum_fn pi_kernel(pi_variant variant) {
+    return kernels[(variant == PI_AUTO) ? pi_kernel_selected() : variant];
+}
+
+int pi_kernel_select(pi_variant variant) {
+    cpu_isa isa = cpu_detect_isa();
+    
+    if (variant == PI_AUTO) {
+        variant = (isa == ISA_AVX512) ? PI_AVX512_NEWTON : (isa == ISA_AVX2) ? PI_AVX2_NEWTON : PI_SCALAR;
+    }
+    if (((variant == PI_AVX2 || variant == PI_AVX2_NEWTON) && isa < ISA_AVX2) ||
+        ((variant == PI_AVX512 || variant == PI_AVX512_NEWTON) && isa < ISA_AVX512)) {
+        return -1;
+    }
+    
+    selected = variant;
+    return 0;
+}
+
+pi_variant pi_kernel_selected(void) {
+    if (selected == PI_AUTO) {
+        pi_kernel_select(PI_AUTO);
+    }
+    return selected;
+}
+
+int pi_parse_variant(const char *name) {
+    for (int v = PI_AUTO; v <= PI_AVX512_NEWTON; v++) {
+        if (strcmp(name, pi_variant_name((pi_variant)v)) == 0) {
+            return v;
+        }
+    }
+    return -1;
+}
+
+const char* pi_variant_name(pi_variant variant) {
+    switch (variant) {
+        case PI_SCALAR:        return "scalar";
+        case PI_AVX2:          return "avx2";
+        case PI_AVX2_NEWTON:   return "avx2-newton";
+        case PI_AVX512:        return "avx512";
+        case PI_AVX512_NEWTON: return "avx512-newton";
+        default:               return "auto";
+    }
+}
@@ -0,0 +1,50 @@
+#ifndef PI_COMPUTE_H
+#define PI_COMPUTE_H
+
+// Midpoint-rule kernels for the pi tasks: 4 / (1 + x^2) summed over the
+// samples [begin, end) of the precision samples of [0, 1), not yet scaled
+// by the step (pi is the sum over [0, precision) times 1 / precision)
+
+typedef double (*pi_sum_fn)(unsigned long precision, unsigned long begin, unsigned long end);
+
+// Kernel variants
+typedef enum {
+    PI_AUTO,           // best variant the CPU supports
+    PI_SCALAR,         // original loop, one division per sample (reference)
+    PI_AVX2,           // 4 lanes, exact division
+    PI_AVX2_NEWTON,    // 4 lanes, single precision estimate + 3 Newton steps
+    PI_AVX512,         // 8 lanes, exact division
+    PI_AVX512_NEWTON   // 8 lanes, rcp14 estimate + 2 Newton steps
+} pi_variant;
+
+// Accuracy guarantee of every variant against PI_SCALAR: the results agree
+// to this relative tolerance. Division variants differ only in the order of
+// the additions; the Newton variants are within 2 ulp of the exact
+// reciprocal per sample on top of that. bench_pi checks it.
+#define PI_KERNEL_TOLERANCE 1e-12
+
+// Select the variant used by compute_pi(); returns -1 if the CPU lacks it.
+// PI_AUTO resolves via CPUID.
+int pi_kernel_select(pi_variant variant);
+
+// Currently selected variant (resolved, never PI_AUTO)
+pi_variant pi_kernel_selected(void);
+
+// Kernel of a variant (PI_AUTO: the selected one)
+pi_sum_fn pi_kernel(pi_variant variant);
+
+// Parse a variant name (auto, scalar, avx2, avx2-newton, avx512,
+// avx512-newton); returns -1 if unknown
+int pi_parse_variant(const char *name);
+
+// Printable name of a variant
+const char* pi_variant_name(pi_variant variant);
+
+// Individual variants (the SIMD ones require the matching CPU support)
+double pi_sum_scalar(unsigned long precision, unsigned long begin, unsigned long end);
+double pi_sum_avx2(unsigned long precision, unsigned long begin, unsigned long end);
+double pi_sum_avx2_newton(unsigned long precision, unsigned long begin, unsigned long end);
+double pi_sum_avx512(unsigned long precision, unsigned long begin, unsigned long end);
+double pi_sum_avx512_newton(unsigned long precision, unsigned long begin, unsigned long end);
+
+#endif
@@ -0,0 +1,345 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <omp.h>
+#include "pi_compute.h"
+#include "pi_kernels.h"
+#include "phase_profile.h"
+
+void pi_options_init(pi_options *opts) {
+    opts->split_threshold = PI_SPLIT_DEFAULT;
+    opts->budget = PI_BUDGET_BLOCKS;
+    opts->budget_block = PI_BUDGET_BLOCK_DEFAULT;
+    opts->reproducible = 0;
+}
+
+// Partial sum of piece k of a task with precision samples
+static double piece_sum(pi_sum_fn kernel, unsigned long precision, long k) {
+    unsigned long begin = (unsigned long)k * PI_PIECE_SAMPLES;
+    unsigned long end = (begin + PI_PIECE_SAMPLES < precision) ? begin + PI_PIECE_SAMPLES : precision;
+    return kernel(precision, begin, end);
+}
+
+double compute_pi(unsigned long precision) {
+    pi_sum_fn kernel = pi_kernel(PI_AUTO);
+    long pieces = (precision + PI_PIECE_SAMPLES - 1) / PI_PIECE_SAMPLES;
+    double sum = 0.0;
+    for (long k = 0; k < pieces; k++) {
+        sum += piece_sum(kernel, precision, k);
+    }
+    return sum * (1.0 / (double)precision);
+}
+
+// Same as compute_pi(), with the pieces spread over child tasks of about
+// threshold samples each; the partial sums are added in piece order, so
+// the result is bit-identical
+static double split_pi(unsigned long precision, unsigned long threshold) {
+    long pieces = (precision + PI_PIECE_SAMPLES - 1) / PI_PIECE_SAMPLES;
+    long grain = (threshold > PI_PIECE_SAMPLES) ? (long)(threshold / PI_PIECE_SAMPLES) : 1;
+    double *partial = (double*) malloc(pieces * sizeof(double));
+    if (partial == NULL) {
+        return compute_pi(precision);
+    }
+    
+    pi_sum_fn kernel = pi_kernel(PI_AUTO);
+    #pragma omp taskloop grainsize(grain)
+    for (long k = 0; k < pieces; k++) {
+        profile_enter(PROF_PI_TASK);
+        partial[k] = piece_sum(kernel, precision, k);
+        profile_leave(PROF_PI_TASK);
+    }
+    
+    double sum = 0.0;
+    for (long k = 0; k < pieces; k++) {
+        sum += partial[k];
+    }
+    free(partial);
+    return sum * (1.0 / (double)precision);
+}
+
+// Per-thread accumulators, one cache line each
+typedef struct {
+    double pi;          // sum of the pi values of the tasks run
+    int spawned;        // children spawned (block budget)
+    int atomics;        // atomic updates of the shared counters
+    char padding[CACHE_LINE_SIZE - sizeof(double) - 2 * sizeof(int)];
+} pi_thread_stats;
+
+// State shared by all tasks of one tree
+typedef struct {
+    int num_tasks;
+    unsigned long lower;
+    unsigned long upper;
+    int num_threads;
+    const pi_options *opts;
+    int tasks_created;              // children reserved (PI_BUDGET_ATOMIC)
+    int pool_taken;                 // task IDs handed out in blocks (PI_BUDGET_BLOCKS)
+    pi_thread_stats *stats;
+    padded_int *tasks_per_thread;
+} pi_tree;
+
+// No task IDs left for new children (a plain read of the shared counter)
+static int budget_exhausted(pi_tree *tree) {
+    int used;
+    if (tree->opts->budget == PI_BUDGET_ATOMIC) {
+        #pragma omp atomic read
+        used = tree->tasks_created;
+    } else {
+        #pragma omp atomic read
+        used = tree->pool_taken;
+    }
+    return used >= tree->num_tasks;
+}
+
+// Reserve a block of at least wanted task IDs from the global pool; returns
+// how many were granted (fewer, or none, at the end of the pool)
+static int refill_budget(pi_tree *tree, int wanted, int thread_id) {
+    int block = (wanted > tree->opts->budget_block) ? wanted : tree->opts->budget_block;
+    int end;
+    #pragma omp atomic capture
+    {
+        tree->pool_taken += block;
+        end = tree->pool_taken;
+    }
+    tree->stats[thread_id].atomics++;
+    int begin = end - block;
+    if (begin >= tree->num_tasks) {
+        return 0;
+    }
+    return (end <= tree->num_tasks) ? block : tree->num_tasks - begin;
+}
+
+// Recursive function to spawn tasks. With PI_BUDGET_BLOCKS every task
+// carries a budget of task IDs for its subtree: it spawns its children from
+// it, hands what is left on to them and only touches the global pool when
+// the budget runs short. Every ID ends up in a spawned child, so exactly
+// num_tasks children are created.
+static void spawn_pi_task(pi_tree *tree, unsigned long task_seed, int budget) {
+    int thread_id = omp_get_thread_num();
+    profile_enter(PROF_PI_TASK);
+    
+    // Compute precision for this task using deterministic seed
+    unsigned long state = task_seed;
+    unsigned long precision = my_rand(&state, tree->lower, tree->upper);
+    
+    // Compute pi; large tasks split their sum into child tasks, and once the
+    // budget is spent (only the tail is left) smaller ones do as well
+    unsigned long threshold = tree->opts->split_threshold;
+    if (threshold > 0 && budget_exhausted(tree)) {
+        threshold /= PI_TAIL_SPLIT_DIVISOR;
+    }
+    double pi_value = (tree->num_threads > 1 && threshold > 0 && precision > threshold)
+        ? split_pi(precision, threshold) : compute_pi(precision);
+    
+    // Update thread-local accumulators (no atomic needed - each thread owns its slot)
+    tree->stats[thread_id].pi += pi_value;
+    tree->tasks_per_thread[thread_id].count++;
+    
+    // Determine how many new tasks to spawn (1-4)
+    unsigned long spawn_state = hash(task_seed);
+    int num_new_tasks = my_rand(&spawn_state, 1, 5);  // Returns 1-4
+    
+    int actual_spawn = num_new_tasks;
+    if (tree->opts->budget == PI_BUDGET_ATOMIC) {
+        // Single atomic operation for all children instead of per-spawn checks
+        int current_count;
+        #pragma omp atomic capture
+        {
+            tree->tasks_created += num_new_tasks;
+            current_count = tree->tasks_created;
+        }
+        tree->stats[thread_id].atomics++;
+        
+        // Adjust if we exceeded the limit
+        if (current_count > tree->num_tasks) {
+            actual_spawn = num_new_tasks - (current_count - tree->num_tasks);
+            if (actual_spawn < 0) actual_spawn = 0;
+        }
+    } else {
+        // Spawn from the own budget, refilled in blocks while the pool lasts
+        if (budget < num_new_tasks && !budget_exhausted(tree)) {
+            budget += refill_budget(tree, num_new_tasks - budget, thread_id);
+        }
+        actual_spawn = (budget < num_new_tasks) ? budget : num_new_tasks;
+        budget -= actual_spawn;
+        tree->stats[thread_id].spawned += actual_spawn;
+    }
+    
+    // Spawn child tasks
+    for (int i = 0; i < actual_spawn; i++) {
+        // Create unique seed for child task using hash and concatenate
+        unsigned long child_seed = hash(task_seed * concatenate(i + 1, thread_id + 1));
+        
+        // The rest of the budget is split evenly among the children
+        int child_budget = budget / actual_spawn + (i < budget % actual_spawn);
+        
+        #pragma omp task firstprivate(child_seed, child_budget)
+        {
+            spawn_pi_task(tree, child_seed, child_budget);
+        }
+    }
+    profile_leave(PROF_PI_TASK);
+}
+
+// Pairwise (cascade) sum of v[0..n) in a fixed order; the rounding error
+// grows with log(n) instead of n
+static double pairwise_sum(const double *v, long n) {
+    if (n <= 8) {
+        double sum = 0.0;
+        for (long i = 0; i < n; i++) {
+            sum += v[i];
+        }
+        return sum;
+    }
+    long half = n / 2;
+    return pairwise_sum(v, half) + pairwise_sum(v + half, n - half);
+}
+
+// Task in run order: larger precision first, ties by task ID so the order
+// is fully determined
+typedef struct {
+    unsigned long precision;
+    long id;
+} pi_order_key;
+
+static int compare_precision_desc(const void *a, const void *b) {
+    const pi_order_key *x = (const pi_order_key*)a;
+    const pi_order_key *y = (const pi_order_key*)b;
+    if (x->precision != y->precision) {
+        return (x->precision < y->precision) ? 1 : -1;
+    }
+    return (x->id > y->id) - (x->id < y->id);
+}
+
+// Reproducible mode. The tree is a pure function of the seed: a child's
+// seed depends only on its parent's seed and its position among the
+// siblings, and tasks are admitted in breadth-first ID order (root 0, its
+// children 1.., and so on) up to num_tasks children. The tasks then run as
+// a dynamic loop, largest precision first, each result is stored under its
+// ID and the IDs are reduced pairwise in order, so the average is
+// bitwise-identical for any number of threads.
+static int run_reproducible(int num_tasks, int num_threads, unsigned long lower, unsigned long upper,
+                            unsigned long seed, pi_result *result) {
+    long count = (long)num_tasks + 1;
+    unsigned long *seeds = (unsigned long*) malloc(count * sizeof(unsigned long));
+    double *values = (double*) malloc(count * sizeof(double));
+    pi_order_key *order = (pi_order_key*) malloc(count * sizeof(pi_order_key));
+    padded_int *tasks_per_thread = (padded_int*) calloc(num_threads, sizeof(padded_int));
+    if (seeds == NULL || values == NULL || order == NULL || tasks_per_thread == NULL) {
+        free(seeds);
+        free(values);
+        free(order);
+        free(tasks_per_thread);
+        return -1;
+    }
+    
+    // Breadth-first admission: the queue of admitted tasks is the ID order
+    seeds[0] = seed;
+    long admitted = 1;
+    for (long id = 0; id < admitted && admitted < count; id++) {
+        unsigned long spawn_state = hash(seeds[id]);
+        int num_new_tasks = my_rand(&spawn_state, 1, 5);  // Returns 1-4
+        for (int i = 0; i < num_new_tasks && admitted < count; i++) {
+            seeds[admitted++] = hash(seeds[id] * concatenate(i + 1, 1));
+        }
+    }
+    for (long id = 0; id < admitted; id++) {
+        unsigned long state = seeds[id];
+        order[id].precision = my_rand(&state, lower, upper);
+        order[id].id = id;
+    }
+    qsort(order, admitted, sizeof(pi_order_key), compare_precision_desc);
+    
+    // Resolve the kernel variant before the threads start calling it
+    pi_kernel_selected();
+    
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+    for (long k = 0; k < admitted; k++) {
+        long id = order[k].id;
+        profile_enter(PROF_PI_TASK);
+        values[id] = compute_pi(order[k].precision);
+        tasks_per_thread[omp_get_thread_num()].count++;
+        profile_leave(PROF_PI_TASK);
+    }
+    
+    // Calculate average (only count valid tasks; the root is not one)
+    int tasks_created = (int)(admitted - 1);
+    result->tasks_created = tasks_created;
+    result->valid_tasks = tasks_created;
+    result->average_pi = pairwise_sum(values, admitted) / result->valid_tasks;
+    result->atomic_updates = 0;
+    result->tasks_per_thread = tasks_per_thread;
+    
+    free(seeds);
+    free(values);
+    free(order);
+    return 0;
+}
+
+int run_pi_tasks(int num_tasks, int num_threads, unsigned long lower, unsigned long upper,
+                 unsigned long seed, const pi_options *opts, pi_result *result) {
+    pi_options defaults;
+    if (opts == NULL) {
+        pi_options_init(&defaults);
+        opts = &defaults;
+    }
+    if (opts->reproducible) {
+        return run_reproducible(num_tasks, num_threads, lower, upper, seed, result);
+    }
+    
+    // Use padded arrays to prevent false sharing
+    pi_thread_stats *stats = (pi_thread_stats*) calloc(num_threads, sizeof(pi_thread_stats));
+    padded_int *tasks_per_thread = (padded_int*) calloc(num_threads, sizeof(padded_int));
+    
+    if (tasks_per_thread == NULL || stats == NULL) {
+        free(tasks_per_thread);
+        free(stats);
+        return -1;
+    }
+    
+    // Shared variables
+    pi_tree tree = { num_tasks, lower, upper, num_threads, opts, 0, 0, stats, tasks_per_thread };
+    
+    // Resolve the kernel variant before the tasks start calling it
+    pi_kernel_selected();
+    
+    // Create initial task region
+    #pragma omp parallel num_threads(num_threads)
+    {
+        #pragma omp single
+        {
+            // Spawn the initial task (it fetches its budget from the pool)
+            #pragma omp task
+            {
+                spawn_pi_task(&tree, seed, 0);
+            }
+            
+            // Wait for all tasks to complete
+            #pragma omp taskwait
+        }
+    }
+    
+    // Sum up thread-local contributions
+    double total_pi = 0.0;
+    int spawned = 0;
+    long atomics = 0;
+    for (int i = 0; i < num_threads; i++) {
+        total_pi += stats[i].pi;
+        spawned += stats[i].spawned;
+        atomics += stats[i].atomics;
+    }
+    free(stats);
+    
+    // Calculate average (only count valid tasks)
+    int tasks_created = (opts->budget == PI_BUDGET_ATOMIC) ? tree.tasks_created : spawned;
+    result->tasks_created = tasks_created;
+    result->valid_tasks = (tasks_created <= num_tasks) ? tasks_created : num_tasks;
+    result->average_pi = total_pi / result->valid_tasks;
+    result->atomic_updates = atomics;
+    result->tasks_per_thread = tasks_per_thread;
+    return 0;
+}
+
+void pi_result_free(pi_result *result) {
+    free(result->tasks_per_thread);
+    result->tasks_per_thread = NULL;
+}
@@ -0,0 +1,67 @@
+#ifndef PI_KERNELS_H
+#define PI_KERNELS_H
+
+#include "common.h"
+
+// Recursive pi task tree: every task integrates pi with a seeded precision
+// in [lower, upper) and spawns 1-4 children until num_tasks exist
+
+// Samples per piece of a task's Riemann sum. A task's sum is always the
+// ordered sum of its pieces' partial sums, however the pieces were spread
+// over threads, so splitting never changes the result.
+#define PI_PIECE_SAMPLES 65536
+
+// Default precision above which a task splits its sum into child tasks
+#define PI_SPLIT_DEFAULT (4 * PI_PIECE_SAMPLES)
+
+// Once the task budget is exhausted only the tail of the tree is left; the
+// split threshold is divided by this factor so that the last large tasks
+// spread over the otherwise idle threads
+#define PI_TAIL_SPLIT_DIVISOR 4
+
+// Task IDs a task takes from the global pool when its own budget runs short
+#define PI_BUDGET_BLOCK_DEFAULT 64
+
+// How the num_tasks cap on new children is enforced. The schemes admit
+// different children, so their trees and averages differ even on one thread.
+typedef enum {
+    PI_BUDGET_BLOCKS,   // per-subtree budgets, refilled from a global pool in blocks
+    PI_BUDGET_ATOMIC    // one shared counter, one atomic update per task
+} pi_budget;
+
+typedef struct {
+    unsigned long split_threshold;  // precision above which a task is split (0: never)
+    pi_budget budget;
+    int budget_block;               // minimum refill (PI_BUDGET_BLOCKS)
+    int reproducible;               // position-based seeds, breadth-first admission and
+                                    // an ordered reduction: the average is bitwise
+                                    // identical for any thread count
+} pi_options;
+
+typedef struct {
+    double average_pi;              // mean over the valid tasks
+    int tasks_created;              // children reserved (may exceed num_tasks with
+                                    // PI_BUDGET_ATOMIC) or spawned
+    int valid_tasks;                // min(tasks_created, num_tasks)
+    long atomic_updates;            // atomic updates of the shared budget counters
+    padded_int *tasks_per_thread;   // tasks run by each thread (num_threads entries)
+} pi_result;
+
+// Compute π using Riemann sum (midpoint rule) with the kernel variant
+// selected by pi_kernel_select() (see pi_compute.h), piece by piece
+double compute_pi(unsigned long precision);
+
+// Default options
+void pi_options_init(pi_options *opts);
+
+// Run the task tree on num_threads threads (opts NULL: defaults); returns 0,
+// or -1 when the per-thread arrays cannot be allocated. Split pieces are
+// not tasks of the tree: tasks_per_thread counts every task once, on the
+// thread that ran it.
+int run_pi_tasks(int num_tasks, int num_threads, unsigned long lower, unsigned long upper,
+                 unsigned long seed, const pi_options *opts, pi_result *result);
+
+// Release the per-thread counts of a result
+void pi_result_free(pi_result *result);
+
+#endif
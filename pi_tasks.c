@@ -1,125 +1,66 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <omp.h>
-
-// Cache line size to prevent false sharing
-#define CACHE_LINE_SIZE 64
-
-// Padded integer to avoid false sharing between threads
-typedef struct {
-    int count;
-    char padding[CACHE_LINE_SIZE - sizeof(int)];
-} padded_int;
-
-// Padded double to avoid false sharing between threads
-typedef struct {
-    double value;
-    char padding[CACHE_LINE_SIZE - sizeof(double)];
-} padded_double;
-
-// Hash function
-unsigned long hash(unsigned long x) {
-    x ^= (x >> 21);
-    x *= 2654435761UL;
-    x ^= (x >> 13);
-    x *= 2654435761UL;
-    x ^= (x >> 17);
-    return x;
-}
-
-// Concatenate function
-unsigned concatenate(unsigned x, unsigned y) {
-    unsigned pow = 10;
-    while (y >= pow)
-        pow *= 10;
-    return x * pow + y;
-}
-
-// my_rand function
-unsigned long my_rand(unsigned long* state, unsigned long lower, unsigned long upper) {
-    *state ^= *state >> 12;
-    *state ^= *state << 25;
-    *state ^= *state >> 27;
-    unsigned long result = (*state * 0x2545F4914F6CDD1DULL);
-    unsigned long range = (upper > lower) ? (upper - lower) : 0UL;
-    return (range > 0) ? (result % range + lower) : lower;
-}
-
-// Compute π using Riemann sum (midpoint rule)
-double compute_pi(unsigned long precision) {
-    double sum = 0.0;
-    double step = 1.0 / (double)precision;
-    double half_step = 0.5 * step;
-    
-    // Optimized: precompute half_step, reduce operations per iteration
-    #pragma omp simd reduction(+:sum)
-    for (unsigned long i = 0; i < precision; i++) {
-        double x = i * step + half_step;
-        double x_sq = x * x;
-        sum += 4.0 / (1.0 + x_sq);
-    }
-    
-    return sum * step;
-}
-
-// Recursive function to spawn tasks
-void spawn_pi_task(unsigned long task_seed, int *tasks_created, int num_tasks, 
-                   unsigned long lower, unsigned long upper, padded_double *thread_pi, 
-                   padded_int *tasks_per_thread, int num_threads) {
-    
-    int thread_id = omp_get_thread_num();
-    
-    // Compute precision for this task using deterministic seed
-    unsigned long state = task_seed;
-    unsigned long precision = my_rand(&state, lower, upper);
-    
-    // Compute pi
-    double pi_value = compute_pi(precision);
-    
-    // Update thread-local accumulators (no atomic needed - each thread owns its slot)
-    thread_pi[thread_id].value += pi_value;
-    tasks_per_thread[thread_id].count++;
-    
-    // Determine how many new tasks to spawn (1-4)
-    unsigned long spawn_state = hash(task_seed);
-    int num_new_tasks = my_rand(&spawn_state, 1, 5);  // Returns 1-4
-    
-    // OPTIMIZATION: Single atomic operation for all children instead of per-spawn checks
-    // This reduces atomic operations from ~4 per task to ~1 per task
-    int current_count;
-    #pragma omp atomic capture
-    {
-        *tasks_created += num_new_tasks;
-        current_count = *tasks_created;
-    }
-    
-    // Adjust if we exceeded the limit
-    int actual_spawn = num_new_tasks;
-    if (current_count > num_tasks) {
-        actual_spawn = num_new_tasks - (current_count - num_tasks);
-        if (actual_spawn < 0) actual_spawn = 0;
-    }
-    
-    // Spawn child tasks
-    for (int i = 0; i < actual_spawn; i++) {
-        // Create unique seed for child task using hash and concatenate
-        unsigned long child_seed = hash(task_seed * concatenate(i + 1, thread_id + 1));
-        
-        #pragma omp task firstprivate(child_seed)
-        {
-            spawn_pi_task(child_seed, tasks_created, num_tasks, lower, upper, 
-                         thread_pi, tasks_per_thread, num_threads);
-        }
-    }
-}
+#include "phase_profile.h"
+#include "pi_compute.h"
+#include "pi_kernels.h"
 
 int main(int argc, char *argv[]) {
     // Check command-line arguments
-    if (argc != 6) {
-        fprintf(stderr, "Usage: %s <num_tasks> <num_threads> <lower> <upper> <seed>\n", argv[0]);
+    if (argc < 6) {
+        fprintf(stderr, "Usage: %s <num_tasks> <num_threads> <lower> <upper> <seed> [options]\n", argv[0]);
+        fprintf(stderr, "Options:\n");
+        fprintf(stderr, "  --kernel=auto|scalar|avx2|avx2-newton|avx512|avx512-newton\n");
+        fprintf(stderr, "                               compute_pi variant (default auto)\n");
+        fprintf(stderr, "  --split=N                    split the sum of tasks above N samples over\n");
+        fprintf(stderr, "                               child tasks (0: never, default %d; divided\n", PI_SPLIT_DEFAULT);
+        fprintf(stderr, "                               by %d once all tasks are created)\n", PI_TAIL_SPLIT_DIVISOR);
+        fprintf(stderr, "  --budget=blocks|atomic       task cap: per-subtree budgets refilled from a\n");
+        fprintf(stderr, "                               global pool (default), or one shared counter\n");
+        fprintf(stderr, "                               (the average of earlier versions)\n");
+        fprintf(stderr, "  --budget-block=N             minimum pool refill (default %d)\n", PI_BUDGET_BLOCK_DEFAULT);
+        fprintf(stderr, "  --reproducible               tree and average independent of the thread count\n");
+        fprintf(stderr, "                               (position-based seeds, breadth-first admission,\n");
+        fprintf(stderr, "                               pairwise sum in task order)\n");
         return 1;
     }
     
+    // Optional switches after the positional arguments
+    pi_options opts;
+    pi_options_init(&opts);
+    for (int a = 6; a < argc; a++) {
+        if (strncmp(argv[a], "--kernel=", 9) == 0) {
+            int variant = pi_parse_variant(argv[a] + 9);
+            if (variant < 0 || pi_kernel_select((pi_variant)variant) != 0) {
+                fprintf(stderr, "Error: Pi kernel %s is not available\n", argv[a] + 9);
+                return 1;
+            }
+        } else if (strncmp(argv[a], "--split=", 8) == 0) {
+            char *end;
+            opts.split_threshold = strtoul(argv[a] + 8, &end, 10);
+            if (*end != '\0' || argv[a][8] == '\0' || argv[a][8] == '-') {
+                fprintf(stderr, "Error: Invalid split threshold %s\n", argv[a] + 8);
+                return 1;
+            }
+        } else if (strcmp(argv[a], "--budget=blocks") == 0) {
+            opts.budget = PI_BUDGET_BLOCKS;
+        } else if (strcmp(argv[a], "--budget=atomic") == 0) {
+            opts.budget = PI_BUDGET_ATOMIC;
+        } else if (strcmp(argv[a], "--reproducible") == 0) {
+            opts.reproducible = 1;
+        } else if (strncmp(argv[a], "--budget-block=", 15) == 0) {
+            opts.budget_block = atoi(argv[a] + 15);
+            if (opts.budget_block <= 0) {
+                fprintf(stderr, "Error: Invalid budget block %s\n", argv[a] + 15);
+                return 1;
+            }
+        } else {
+            fprintf(stderr, "Error: Unknown option %s\n", argv[a]);
+            return 1;
+        }
+    }
+    
     // Parse command-line arguments
     int num_tasks = atoi(argv[1]);
     int num_threads = atoi(argv[2]);
@@ -129,6 +70,7 @@ int main(int argc, char *argv[]) {
     
     // Set number of OpenMP threads
     omp_set_num_threads(num_threads);
+    profile_init("pi_tasks");
     
     // Validate input
     if (num_tasks <= 0 || num_threads <= 0 || upper <= lower) {
@@ -139,58 +81,25 @@ int main(int argc, char *argv[]) {
     // Start timing
     double start_time = omp_get_wtime();
     
-    // Shared variables
-    int tasks_created = 0;
-    
-    // Use padded arrays to prevent false sharing
-    padded_double *thread_pi = (padded_double*) calloc(num_threads, sizeof(padded_double));
-    padded_int *tasks_per_thread = (padded_int*) calloc(num_threads, sizeof(padded_int));
-    
-    if (tasks_per_thread == NULL || thread_pi == NULL) {
+    pi_result result;
+    if (run_pi_tasks(num_tasks, num_threads, lower, upper, seed, &opts, &result) != 0) {
         fprintf(stderr, "Error: Memory allocation failed\n");
         return 1;
     }
     
-    // Create initial task region
-    #pragma omp parallel
-    {
-        #pragma omp single
-        {
-            // Spawn the initial task
-            #pragma omp task
-            {
-                spawn_pi_task(seed, &tasks_created, num_tasks, lower, upper, 
-                             thread_pi, tasks_per_thread, num_threads);
-            }
-            
-            // Wait for all tasks to complete
-            #pragma omp taskwait
-        }
-    }
-    
-    // Sum up thread-local contributions
-    double total_pi = 0.0;
-    for (int i = 0; i < num_threads; i++) {
-        total_pi += thread_pi[i].value;
-    }
-    
-    // Calculate average (only count valid tasks)
-    int valid_tasks = (tasks_created <= num_tasks) ? tasks_created : num_tasks;
-    double average_pi = total_pi / valid_tasks;
-    
     // Output results (per spec: timing ends AFTER printing output)
-    printf("Average pi: %.10f\n", average_pi);
+    printf("Average pi: %.10f\n", result.average_pi);
     for (int i = 0; i < num_threads; i++) {
-        printf("Thread %d computed %d tasks\n", i, tasks_per_thread[i].count);
+        printf("Thread %d computed %d tasks\n", i, result.tasks_per_thread[i].count);
     }
     
     // End timing after printing results (per specification)
     double end_time = omp_get_wtime();
     printf("Execution took %.4f s\n", end_time - start_time);
+    profile_report();
     
     // Clean up
-    free(tasks_per_thread);
-    free(thread_pi);
+    pi_result_free(&result);
     
     return 0;
 }
@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "rect_sums.h"
+
+int parse_rect_shapes(const char *list, rect_shape **shapes) {
+    int count = 1;
+    for (const char *p = list; *p; p++) {
+        if (*p == ',') count++;
+    }
+    
+    *shapes = (rect_shape*) malloc(count * sizeof(rect_shape));
+    if (*shapes == NULL) {
+        return -1;
+    }
+    
+    const char *p = list;
+    for (int k = 0; k < count; k++) {
+        char *end;
+        long height = strtol(p, &end, 10);
+        if (end == p || (*end != 'x' && *end != 'X')) {
+            free(*shapes);
+            *shapes = NULL;
+            return -1;
+        }
+        p = end + 1;
+        long width = strtol(p, &end, 10);
+        if (end == p || height <= 0 || width <= 0 || height > 0x7fffffff || width > 0x7fffffff ||
+            (*end != ',' && *end != '\0')) {
+            free(*shapes);
+            *shapes = NULL;
+            return -1;
+        }
+        (*shapes)[k].height = (int)height;
+        (*shapes)[k].width = (int)width;
+        p = end + 1;
+    }
+    return count;
+}
+
+u128* build_summed_area_table(const unsigned long *heatmap, long rows, int cols) {
+    size_t stride = (size_t)cols + 1;
+    u128 *sat = (u128*) malloc((size_t)(rows + 1) * stride * sizeof(u128));
+    
+    // One row tile per thread
+    u128 *carry = (u128*) calloc((size_t)omp_get_max_threads() * stride, sizeof(u128));
+    
+    if (sat == NULL || carry == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    
+    memset(sat, 0, stride * sizeof(u128));
+    
+    #pragma omp parallel
+    {
+        int tile = omp_get_thread_num();
+        int num_tiles = omp_get_num_threads();
+        long tile_begin = rows * tile / num_tiles;
+        long tile_end = rows * (tile + 1) / num_tiles;
+        
+        // Pass 1: table local to the row tile (row prefix plus the row above
+        // within the tile); the tile's last row becomes its carry
+        for (long r = tile_begin; r < tile_end; r++) {
+            const unsigned long *row = &heatmap[(size_t)r * cols];
+            u128 *out = &sat[(size_t)(r + 1) * stride];
+            const u128 *above = (r > tile_begin) ? out - stride : NULL;
+            u128 row_sum = 0;
+            
+            out[0] = 0;
+            for (int c = 0; c < cols; c++) {
+                row_sum += row[c];
+                out[c + 1] = row_sum + (above ? above[c + 1] : 0);
+            }
+        }
+        if (tile_end > tile_begin) {
+            memcpy(&carry[(size_t)tile * stride], &sat[(size_t)tile_end * stride], stride * sizeof(u128));
+        }
+        
+        #pragma omp barrier
+        
+        // Carries between tiles: exclusive scan over the tiles (short, serial
+        // over tiles, split over columns)
+        #pragma omp for schedule(static)
+        for (int c = 0; c < cols + 1; c++) {
+            u128 running = 0;
+            for (int t = 0; t < num_tiles; t++) {
+                u128 tile_total = carry[(size_t)t * stride + c];
+                carry[(size_t)t * stride + c] = running;
+                running += tile_total;
+            }
+        }
+        
+        // Pass 2: add the sum of all tiles above to every row of the tile
+        if (tile > 0) {
+            const u128 *offset = &carry[(size_t)tile * stride];
+            for (long r = tile_begin; r < tile_end; r++) {
+                u128 *out = &sat[(size_t)(r + 1) * stride];
+                for (int c = 1; c < cols + 1; c++) {
+                    out[c] += offset[c];
+                }
+            }
+        }
+    }
+    
+    free(carry);
+    return sat;
+}
+
+// Better candidate: larger sum, then smaller row, then smaller column
+static inline int rect_better(u128 sum, long row, int col, const rect_result *best) {
+    if (sum != best->sum) {
+        return sum > best->sum;
+    }
+    return (row < best->row) || (row == best->row && col < best->col);
+}
+
+void max_rect_sums(const u128 *sat, long rows, int cols, const rect_shape *shapes,
+                   int num_shapes, rect_result *results) {
+    size_t stride = (size_t)cols + 1;
+    
+    for (int k = 0; k < num_shapes; k++) {
+        results[k].sum = 0;
+        results[k].row = -1;
+        results[k].col = -1;
+    }
+    
+    #pragma omp parallel
+    {
+        for (int k = 0; k < num_shapes; k++) {
+            int height = shapes[k].height;
+            int width = shapes[k].width;
+            rect_result local = { 0, -1, -1 };
+            
+            // Top-left rows split across threads
+            #pragma omp for schedule(static) nowait
+            for (long r = 0; r <= rows - height; r++) {
+                const u128 *top = &sat[(size_t)r * stride];
+                const u128 *bottom = &sat[(size_t)(r + height) * stride];
+                for (int c = 0; c <= cols - width; c++) {
+                    u128 sum = bottom[c + width] - top[c + width] - bottom[c] + top[c];
+                    if (local.row < 0 || rect_better(sum, r, c, &local)) {
+                        local.sum = sum;
+                        local.row = r;
+                        local.col = c;
+                    }
+                }
+            }
+            
+            #pragma omp critical
+            {
+                if (local.row >= 0 && (results[k].row < 0 || rect_better(local.sum, local.row, local.col, &results[k]))) {
+                    results[k] = local;
+                }
+            }
+        }
+    }
+}
+
+char* format_u128(u128 value, char *buf) {
+    char digits[40];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + (int)(value % 10));
+        value /= 10;
+    } while (value != 0);
+    
+    for (int k = 0; k < n; k++) {
+        buf[k] = digits[n - 1 - k];
+    }
+    buf[n] = '\0';
+    return buf;
+}
@@ -0,0 +1,40 @@
+#ifndef RECT_SUMS_H
+#define RECT_SUMS_H
+
+// 2D rectangular window analysis over the preprocessed heatmap. Hashed
+// values use the full 64-bit range, so the summed-area table and all
+// rectangle sums are kept in 128 bits and never wrap.
+
+typedef unsigned __int128 u128;
+
+// Rectangle shape: height rows by width columns
+typedef struct {
+    int height;
+    int width;
+} rect_shape;
+
+// Maximum-sum position of one shape (top-left corner; ties go to the
+// smallest row, then the smallest column)
+typedef struct {
+    u128 sum;
+    long row;
+    int col;
+} rect_result;
+
+// Parse a comma separated list of HxW shapes; returns the count (and a
+// malloc'd array in *shapes) or -1 if the list is malformed
+int parse_rect_shapes(const char *list, rect_shape **shapes);
+
+// Summed-area table with a zero first row and column:
+// sat[r * (cols + 1) + c] = sum of rows [0, r) x columns [0, c).
+// Built with a blocked two-pass scan; the caller frees the result.
+u128* build_summed_area_table(const unsigned long *heatmap, long rows, int cols);
+
+// Maximum-sum rectangle of every shape, positions split across threads
+void max_rect_sums(const u128 *sat, long rows, int cols, const rect_shape *shapes,
+                   int num_shapes, rect_result *results);
+
+// Decimal representation of a 128-bit value (buf must hold 40 chars)
+char* format_u128(u128 value, char *buf);
+
+#endif
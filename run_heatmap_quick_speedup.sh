@@ -26,59 +26,18 @@ SEED=42
 LOWER=0
 UPPER=100
 WINDOW_HEIGHT=50
-VERBOSE=0
 WORK_FACTOR=50
+THREADS=${THREADS:-1,2,4,8,16,32,64}
+REPS=${REPS:-5}
 
 echo ""
 echo "Heatmap Analysis Quick - Speedup Measurement"
-echo ""
-echo "Parameters: columns=$COLS, rows=$ROWS, seed=$SEED"
-echo "lower=$LOWER, upper=$UPPER, window_height=$WINDOW_HEIGHT"
-echo "work_factor=$WORK_FACTOR"
 echo "Node: $(hostname)"
 echo "Date: $(date)"
-echo ""
-
-# Array to store execution times
-declare -a times
 
-# Test with different thread counts
-for THREADS in 1 2 4 8 16 32 64
-do
-    echo ""
-    echo "Running with $THREADS thread(s)..."
-    echo ""
-    
-    # Run the program and capture output
-    output=$(./heatmap_analysis_quick $COLS $ROWS $SEED $LOWER $UPPER $WINDOW_HEIGHT $VERBOSE $THREADS $WORK_FACTOR)
-    
-    # Display output
-    echo "$output"
-    
-    # Extract execution time (format: "Execution took X.XXXX s")
-    time=$(echo "$output" | grep "Execution took" | awk '{print $3}')
-    times[$THREADS]=$time
-    
-    echo ""
-done
-
-echo ""
-echo "Speedup Measurement Summary"
-echo ""
-echo "Thread Count | Time (s) | Speedup | Efficiency"
-echo "-------------|----------|---------|------------"
-
-# Calculate and display speedups
-baseline=${times[1]}
-for THREADS in 1 2 4 8 16 32 64
-do
-    time=${times[$THREADS]}
-    if [ -n "$time" ] && [ -n "$baseline" ]; then
-        speedup=$(awk -v b="$baseline" -v t="$time" 'BEGIN {printf "%.4f", b/t}')
-        efficiency=$(awk -v s="$speedup" -v n="$THREADS" 'BEGIN {printf "%.4f", s/n*100}')
-        printf "%12d | %8s | %7s | %9s%%\n" $THREADS $time $speedup $efficiency
-    fi
-done
-
-echo ""
-echo "Speedup measurement complete!"
+# Runs standalone as well as under sbatch; the harness links the kernels
+# directly and writes a JSON baseline for later --compare runs
+make -s bench_speedup || exit 1
+./bench_speedup --program=quick --threads=$THREADS --sizes=${COLS}x${ROWS} \
+    --work=$WORK_FACTOR --windows=$WINDOW_HEIGHT --seed=$SEED --lower=$LOWER --upper=$UPPER \
+    --reps=$REPS --json=heatmap_quick_speedup.json "$@"
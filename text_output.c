@@ -0,0 +1,198 @@
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <omp.h>
+#include "phase_profile.h"
+#include "text_output.h"
+
+// POSIX minimum; glibc only defines IOV_MAX for _XOPEN_SOURCE
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+// "00" .. "99", so every division by 100 produces two digits at once
+static const char digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+size_t format_u64(char *out, unsigned long long v) {
+    char tmp[20];
+    char *p = tmp + sizeof(tmp);
+    while (v >= 100) {
+        unsigned pair = (unsigned)(v % 100) * 2;
+        v /= 100;
+        p -= 2;
+        p[0] = digit_pairs[pair];
+        p[1] = digit_pairs[pair + 1];
+    }
+    if (v >= 10) {
+        p -= 2;
+        p[0] = digit_pairs[v * 2];
+        p[1] = digit_pairs[v * 2 + 1];
+    } else {
+        *--p = (char)('0' + v);
+    }
+    size_t len = tmp + sizeof(tmp) - p;
+    memcpy(out, p, len);
+    return len;
+}
+
+size_t format_row(char *out, const unsigned long *row, int cols) {
+    char *p = out;
+    for (int j = 0; j < cols; j++) {
+        if (j > 0) *p++ = ',';
+        p += format_u64(p, row[j]);
+    }
+    *p++ = '\n';
+    return p - out;
+}
+
+// writev() everything, resuming after partial writes
+static void write_all(struct iovec *iov, int count) {
+    while (count > 0) {
+        int batch = (count < IOV_MAX) ? count : IOV_MAX;
+        ssize_t written = writev(STDOUT_FILENO, iov, batch);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            fprintf(stderr, "Error: Cannot write output\n");
+            exit(1);
+        }
+        while (count > 0 && (size_t)written >= iov->iov_len) {
+            written -= iov->iov_len;
+            iov++;
+            count--;
+        }
+        if (count > 0) {
+            iov->iov_base = (char*)iov->iov_base + written;
+            iov->iov_len -= written;
+        }
+    }
+}
+
+void team_write(long count, size_t max_item_bytes, render_fn render, const void *ctx) {
+    int thread_id = omp_get_thread_num();
+    int num_threads = omp_get_num_threads();
+    long chunk = OUTPUT_BUFFER_BYTES / max_item_bytes;
+    if (chunk < 1) {
+        chunk = 1;
+    }
+    char *buffer = (char*) malloc(chunk * max_item_bytes);
+    struct iovec *iov = NULL;
+    
+    #pragma omp single copyprivate(iov)
+    {
+        fflush(stdout);
+        iov = (struct iovec*) malloc(num_threads * sizeof(struct iovec));
+    }
+    if (buffer == NULL || iov == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    
+    // Each round renders num_threads consecutive chunks, written in order
+    for (long round = 0; round < count; round += chunk * num_threads) {
+        long begin = round + thread_id * chunk;
+        long end = (begin + chunk < count) ? begin + chunk : count;
+        profile_enter(PROF_OUTPUT);
+        size_t len = (begin < end) ? render(buffer, begin, end, ctx) : 0;
+        profile_leave(PROF_OUTPUT);
+        iov[thread_id].iov_base = buffer;
+        iov[thread_id].iov_len = len;
+        
+        #pragma omp barrier
+        #pragma omp single
+        {
+            profile_enter(PROF_OUTPUT);
+            write_all(iov, num_threads);
+            profile_leave(PROF_OUTPUT);
+        }
+    }
+    
+    free(buffer);
+    #pragma omp single nowait
+    free(iov);
+}
+
+void parallel_write(long count, size_t max_item_bytes, render_fn render, const void *ctx) {
+    #pragma omp parallel
+    team_write(count, max_item_bytes, render, ctx);
+}
+
+typedef struct {
+    const unsigned long *grid;
+    long row_begin;
+    int cols;
+} rows_ctx;
+
+static size_t render_rows(char *out, long begin, long end, const void *ctx) {
+    const rows_ctx *c = (const rows_ctx*)ctx;
+    char *p = out;
+    for (long i = begin; i < end; i++) {
+        p += format_row(p, &c->grid[(size_t)(c->row_begin + i) * c->cols], c->cols);
+    }
+    return p - out;
+}
+
+void write_grid_rows(const unsigned long *grid, long row_begin, long row_end, int cols) {
+    rows_ctx ctx = { grid, row_begin, cols };
+    parallel_write(row_end - row_begin, (size_t)cols * 21, render_rows, &ctx);
+}
+
+void team_write_grid_rows(const unsigned long *grid, long row_begin, long row_end, int cols) {
+    rows_ctx ctx = { grid, row_begin, cols };
+    team_write(row_end - row_begin, (size_t)cols * 21, render_rows, &ctx);
+}
+
+static size_t render_sums(char *out, long begin, long end, const void *ctx) {
+    const unsigned long long *sums = (const unsigned long long*)ctx;
+    char *p = out;
+    for (long j = begin; j < end; j++) {
+        if (j > 0) *p++ = ',';
+        p += format_u64(p, sums[j]);
+    }
+    return p - out;
+}
+
+void write_sums(const unsigned long long *sums, int cols) {
+    parallel_write(cols, 21, render_sums, sums);
+}
+
+static size_t render_count_list(char *out, long begin, long end, const void *ctx) {
+    const padded_int *counts = (const padded_int*)ctx;
+    char *p = out;
+    for (long i = begin; i < end; i++) {
+        if (i > 0) *p++ = ',';
+        p += format_u64(p, (unsigned)counts[i].count);
+    }
+    return p - out;
+}
+
+void write_count_list(const padded_int *hotspots_per_row, long rows) {
+    parallel_write(rows, 11, render_count_list, hotspots_per_row);
+}
+
+static size_t render_hotspot_counts(char *out, long begin, long end, const void *ctx) {
+    const padded_int *counts = (const padded_int*)ctx;
+    char *p = out;
+    for (long i = begin; i < end; i++) {
+        memcpy(p, "Row ", 4);
+        p += 4;
+        p += format_u64(p, (unsigned long long)i);
+        *p++ = ':';
+        *p++ = ' ';
+        p += format_u64(p, (unsigned)counts[i].count);
+        memcpy(p, " hotspot(s)\n", 12);
+        p += 12;
+    }
+    return p - out;
+}
+
+void write_hotspot_counts(const padded_int *hotspots_per_row, long rows) {
+    // "Row " + 19 digits + ": " + 10 digits + " hotspot(s)\n"
+    parallel_write(rows, 48, render_hotspot_counts, hotspots_per_row);
+}
@@ -0,0 +1,46 @@
+#ifndef TEXT_OUTPUT_H
+#define TEXT_OUTPUT_H
+
+#include <stddef.h>
+#include "common.h"
+
+// Parallel text output: threads render consecutive item ranges into private
+// buffers, which are written to stdout in order with writev(). The text is
+// byte-for-byte what the equivalent printf() calls produce; stdout is
+// flushed first so buffered and direct output never interleave.
+
+// Bytes rendered per thread and round
+#define OUTPUT_BUFFER_BYTES (1 << 20)
+
+// Render items [begin, end) into out (room for (end - begin) times the
+// max_item_bytes passed along); returns the number of bytes written
+typedef size_t (*render_fn)(char *out, long begin, long end, const void *ctx);
+
+// Decimal digits of v (no terminator); returns the length (at most 20)
+size_t format_u64(char *out, unsigned long long v);
+
+// One grid row as a comma separated line including the newline (at most
+// 21 bytes per value); returns the length
+size_t format_row(char *out, const unsigned long *row, int cols);
+
+// Write items [0, count) with a parallel region of its own
+void parallel_write(long count, size_t max_item_bytes, render_fn render, const void *ctx);
+
+// Same as parallel_write(), but orphaned: every thread of the enclosing
+// parallel region must call it with the same arguments
+void team_write(long count, size_t max_item_bytes, render_fn render, const void *ctx);
+
+// Grid rows [row_begin, row_end) as comma separated lines
+void write_grid_rows(const unsigned long *grid, long row_begin, long row_end, int cols);
+void team_write_grid_rows(const unsigned long *grid, long row_begin, long row_end, int cols);
+
+// Per-column sums as one comma separated line (no trailing newline)
+void write_sums(const unsigned long long *sums, int cols);
+
+// Per-row hotspot counts as one comma separated line (no trailing newline)
+void write_count_list(const padded_int *hotspots_per_row, long rows);
+
+// "Row i: n hotspot(s)" lines
+void write_hotspot_counts(const padded_int *hotspots_per_row, long rows);
+
+#endif
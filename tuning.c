@@ -0,0 +1,254 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <unistd.h>
+#include <omp.h>
+#include "heatmap_kernels.h"
+#include "tuning.h"
+
+#define DEFAULT_TUNING_FILE "heatmap_tuning.profile"
+
+tuning_config tuning = { omp_sched_static, 0, 0, 0, PLACEMENT_NONE };
+
+static const char *placement_names[] = { "none", "compact", "scatter" };
+
+// Affinity mask of the process before any pinning, restored by PLACEMENT_NONE
+static cpu_set_t inherited_mask;
+static int inherited_saved = 0;
+static placement_kind applied_placement = PLACEMENT_NONE;
+
+// The row loops use schedule(runtime), whose default kind is implementation
+// defined; keep them static unless OMP_SCHEDULE asks for something else
+__attribute__((constructor))
+static void tuning_default_schedule(void) {
+    if (getenv("OMP_SCHEDULE") == NULL) {
+        omp_set_schedule(omp_sched_static, 0);
+    }
+}
+
+static const char *schedule_name(omp_sched_t kind) {
+    switch (kind) {
+        case omp_sched_static: return "static";
+        case omp_sched_dynamic: return "dynamic";
+        case omp_sched_guided: return "guided";
+        default: return "auto";
+    }
+}
+
+static int parse_schedule(const char *name, omp_sched_t *kind) {
+    const omp_sched_t kinds[] = { omp_sched_static, omp_sched_dynamic, omp_sched_guided, omp_sched_auto };
+    for (int k = 0; k < 4; k++) {
+        if (strcmp(name, schedule_name(kinds[k])) == 0) {
+            *kind = kinds[k];
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int parse_placement(const char *name, placement_kind *placement) {
+    for (int p = 0; p < 3; p++) {
+        if (strcmp(name, placement_names[p]) == 0) {
+            *placement = (placement_kind)p;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// Pin every thread of a team of omp_get_max_threads() (the pool is reused
+// by later regions of the same size)
+static void apply_placement(placement_kind placement) {
+    if (!inherited_saved) {
+        CPU_ZERO(&inherited_mask);
+        if (sched_getaffinity(0, sizeof(inherited_mask), &inherited_mask) != 0) {
+            return;
+        }
+        inherited_saved = 1;
+    }
+    if (placement == applied_placement) {
+        return;
+    }
+
+    int allowed[CPU_SETSIZE];
+    int num_allowed = 0;
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &inherited_mask)) {
+            allowed[num_allowed++] = cpu;
+        }
+    }
+
+    #pragma omp parallel
+    {
+        int thread_id = omp_get_thread_num();
+        int num_threads = omp_get_num_threads();
+        cpu_set_t mask;
+        if (placement == PLACEMENT_NONE || num_allowed == 0) {
+            mask = inherited_mask;
+        } else {
+            int slot = (placement == PLACEMENT_COMPACT)
+                ? thread_id % num_allowed
+                : (int)((long)thread_id * num_allowed / num_threads) % num_allowed;
+            CPU_ZERO(&mask);
+            CPU_SET(allowed[slot], &mask);
+        }
+        sched_setaffinity(0, sizeof(mask), &mask);
+    }
+    applied_placement = placement;
+}
+
+void tuning_apply(const tuning_config *cfg) {
+    tuning = *cfg;
+    omp_set_schedule(cfg->schedule, cfg->chunk);
+    apply_placement(cfg->placement);
+}
+
+void tuning_describe(const tuning_config *cfg, char *out, size_t size) {
+    snprintf(out, size, "schedule=%s,%d band_rows=%d col_block=%d placement=%s",
+             schedule_name(cfg->schedule), cfg->chunk, cfg->band_rows, cfg->col_block,
+             placement_names[cfg->placement]);
+}
+
+static const char *tuning_path(void) {
+    const char *path = getenv("HEATMAP_TUNING_FILE");
+    return (path != NULL && path[0] != '\0') ? path : DEFAULT_TUNING_FILE;
+}
+
+// Node type: processor count and L2 size
+static void machine_name(char *out, size_t size) {
+    long l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2 <= 0) {
+        l2 = DEFAULT_L2_BYTES;
+    }
+    snprintf(out, size, "%dcpu-%ldK", omp_get_num_procs(), l2 / 1024);
+}
+
+int tuning_load(const char *engine, long rows, int cols, int num_threads) {
+    FILE *in = fopen(tuning_path(), "r");
+    if (in == NULL) {
+        return -1;
+    }
+    char machine[32];
+    machine_name(machine, sizeof(machine));
+
+    char line[256];
+    int found = 0;
+    tuning_config cfg = tuning;
+    while (fgets(line, sizeof(line), in) != NULL) {
+        char e[16], m[32], kind[16], place[16];
+        long r;
+        int c, t, chunk, band_rows, col_block;
+        if (sscanf(line, "engine=%15s cols=%d rows=%ld threads=%d machine=%31s schedule=%15[a-z],%d "
+                   "band_rows=%d col_block=%d placement=%15s",
+                   e, &c, &r, &t, m, kind, &chunk, &band_rows, &col_block, place) != 10) {
+            continue;
+        }
+        tuning_config entry;
+        if (strcmp(e, engine) != 0 || c != cols || r != rows || t != num_threads ||
+            strcmp(m, machine) != 0 || parse_schedule(kind, &entry.schedule) != 0 ||
+            parse_placement(place, &entry.placement) != 0 || chunk < 0 || band_rows < 0 ||
+            col_block < 0 || col_block > PART_A_COL_BLOCK) {
+            continue;
+        }
+        entry.chunk = chunk;
+        entry.band_rows = band_rows;
+        entry.col_block = col_block;
+        cfg = entry;
+        found = 1;
+    }
+    fclose(in);
+
+    if (!found) {
+        return -1;
+    }
+    tuning_apply(&cfg);
+    return 0;
+}
+
+int tuning_save(const char *engine, long rows, int cols, int num_threads,
+                const tuning_config *cfg, double seconds) {
+    FILE *out = fopen(tuning_path(), "a");
+    if (out == NULL) {
+        fprintf(stderr, "Error: Cannot open %s\n", tuning_path());
+        return -1;
+    }
+    char machine[32];
+    char desc[128];
+    machine_name(machine, sizeof(machine));
+    tuning_describe(cfg, desc, sizeof(desc));
+    fprintf(out, "engine=%s cols=%d rows=%ld threads=%d machine=%s %s seconds=%.6f\n",
+            engine, cols, rows, num_threads, machine, desc, seconds);
+    fclose(out);
+    return 0;
+}
+
+static double time_candidate(const tuning_config *cfg, int reps, double (*run)(void *ctx), void *ctx) {
+    tuning_apply(cfg);
+    double best = 0.0;
+    for (int r = 0; r < reps; r++) {
+        double t = run(ctx);
+        if (r == 0 || t < best) {
+            best = t;
+        }
+    }
+    return best;
+}
+
+double autotune(int uses_bands, int reps, double (*run)(void *ctx), void *ctx, tuning_config *best) {
+    const struct { omp_sched_t kind; int chunk; } schedules[] = {
+        { omp_sched_static, 0 }, { omp_sched_static, 1 }, { omp_sched_static, 16 },
+        { omp_sched_static, 64 }, { omp_sched_dynamic, 1 }, { omp_sched_dynamic, 16 },
+        { omp_sched_dynamic, 64 }, { omp_sched_guided, 1 }, { omp_sched_guided, 16 }
+    };
+    const int col_blocks[] = { 0, 32, 64, 128, 256 };
+    const int band_rows[] = { 0, 2, 8, 32, 128 };
+    const placement_kind placements[] = { PLACEMENT_NONE, PLACEMENT_COMPACT, PLACEMENT_SCATTER };
+
+    tuning_config cfg = { omp_sched_static, 0, 0, 0, PLACEMENT_NONE };
+    *best = cfg;
+    double best_time = time_candidate(&cfg, reps, run, ctx);
+
+    // One knob at a time, each starting from the best configuration so far
+    for (size_t k = 1; k < sizeof(schedules) / sizeof(schedules[0]); k++) {
+        cfg = *best;
+        cfg.schedule = schedules[k].kind;
+        cfg.chunk = schedules[k].chunk;
+        double t = time_candidate(&cfg, reps, run, ctx);
+        if (t < best_time) {
+            best_time = t;
+            *best = cfg;
+        }
+    }
+    for (size_t k = 1; k < sizeof(col_blocks) / sizeof(col_blocks[0]); k++) {
+        cfg = *best;
+        cfg.col_block = col_blocks[k];
+        double t = time_candidate(&cfg, reps, run, ctx);
+        if (t < best_time) {
+            best_time = t;
+            *best = cfg;
+        }
+    }
+    for (size_t k = 1; uses_bands && k < sizeof(band_rows) / sizeof(band_rows[0]); k++) {
+        cfg = *best;
+        cfg.band_rows = band_rows[k];
+        double t = time_candidate(&cfg, reps, run, ctx);
+        if (t < best_time) {
+            best_time = t;
+            *best = cfg;
+        }
+    }
+    for (size_t k = 1; k < sizeof(placements) / sizeof(placements[0]); k++) {
+        cfg = *best;
+        cfg.placement = placements[k];
+        double t = time_candidate(&cfg, reps, run, ctx);
+        if (t < best_time) {
+            best_time = t;
+            *best = cfg;
+        }
+    }
+
+    tuning_apply(best);
+    return best_time;
+}
@@ -0,0 +1,52 @@
+#ifndef TUNING_H
+#define TUNING_H
+
+#include <stddef.h>
+#include <omp.h>
+
+// Run-time layout knobs of the heatmap kernels and their autotuner.
+// The row loops use schedule(runtime); band and column block sizes and the
+// thread placement are read from the active configuration. A tuned
+// configuration is stored per engine, grid shape, thread count and machine
+// in a profile file (HEATMAP_TUNING_FILE, default heatmap_tuning.profile)
+// that later runs load automatically.
+
+typedef enum {
+    PLACEMENT_NONE,     // inherited affinity mask
+    PLACEMENT_COMPACT,  // thread t on the t-th allowed CPU
+    PLACEMENT_SCATTER   // threads spread evenly over the allowed CPUs
+} placement_kind;
+
+typedef struct {
+    omp_sched_t schedule;       // schedule(runtime) kind
+    int chunk;                  // 0: the kind's default chunk
+    int band_rows;              // rows per thread and band, 0: derived from L2
+    int col_block;              // Part A column block, 0: PART_A_COL_BLOCK rule
+    placement_kind placement;
+} tuning_config;
+
+// Active configuration (static schedule, cache-derived sizes, no pinning)
+extern tuning_config tuning;
+
+// Make cfg the active configuration: sets the run-sched-var and pins (or
+// unpins) the threads of the next parallel regions
+void tuning_apply(const tuning_config *cfg);
+
+// Load and apply the profile entry for this engine, shape and machine;
+// returns 0 when one was found, -1 otherwise
+int tuning_load(const char *engine, long rows, int cols, int num_threads);
+
+// Append an entry to the profile file (the last matching entry wins)
+int tuning_save(const char *engine, long rows, int cols, int num_threads,
+                const tuning_config *cfg, double seconds);
+
+// Coordinate search over schedule and chunk, Part A column block, band
+// rows (only when uses_bands) and placement. Every candidate is applied and
+// timed as the best of reps calls of run(ctx); the winner is applied,
+// stored in best and its time returned.
+double autotune(int uses_bands, int reps, double (*run)(void *ctx), void *ctx, tuning_config *best);
+
+// "schedule=dynamic,16 band_rows=0 col_block=128 placement=compact"
+void tuning_describe(const tuning_config *cfg, char *out, size_t size);
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <omp.h>
+#include "heatmap_kernels.h"
+#include "window_prefix.h"
+
+int parse_window_heights(const char *list, int **heights) {
+    int count = 1;
+    for (const char *p = list; *p; p++) {
+        if (*p == ',') count++;
+    }
+    
+    *heights = (int*) malloc(count * sizeof(int));
+    if (*heights == NULL) {
+        return -1;
+    }
+    
+    const char *p = list;
+    for (int h = 0; h < count; h++) {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value <= 0 || value > 0x7fffffff || (*end != ',' && *end != '\0')) {
+            free(*heights);
+            *heights = NULL;
+            return -1;
+        }
+        (*heights)[h] = (int)value;
+        p = end + 1;
+    }
+    return count;
+}
+
+// Add one grid row to the previous prefix row (vectorized over columns)
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static void prefix_step(const unsigned long long *prev, const unsigned long *row,
+                        unsigned long long *next, int n) {
+    #pragma omp simd
+    for (int c = 0; c < n; c++) {
+        next[c] = prev[c] + row[c];
+    }
+}
+
+unsigned long long* build_column_prefix(const unsigned long *heatmap, long rows, int cols) {
+    unsigned long long *prefix = (unsigned long long*) malloc((size_t)(rows + 1) * cols * sizeof(unsigned long long));
+    if (prefix == NULL) {
+        fprintf(stderr, "Error: Memory allocation failed\n");
+        exit(1);
+    }
+    
+    int block = column_block_size(cols, omp_get_max_threads());
+    int num_blocks = (cols + block - 1) / block;
+    
+    // Threads split column blocks and sweep the rows in order
+    #pragma omp parallel for schedule(static)
+    for (int cb = 0; cb < num_blocks; cb++) {
+        int col_start = cb * block;
+        int n = (col_start + block < cols) ? block : cols - col_start;
+        
+        memset(&prefix[col_start], 0, n * sizeof(unsigned long long));
+        for (long r = 0; r < rows; r++) {
+            prefix_step(&prefix[(size_t)r * cols + col_start], &heatmap[(size_t)r * cols + col_start],
+                        &prefix[(size_t)(r + 1) * cols + col_start], n);
+        }
+    }
+    
+    return prefix;
+}
+
+// Max over all window starts of prefix[s + h] - prefix[s] for one column block
+__attribute__((target_clones("avx512f", "avx2", "default")))
+static void max_window_block(const unsigned long long *prefix, long rows, int cols, int height,
+                             int col_start, int n, unsigned long long *max_sums) {
+    const unsigned long long *top = &prefix[col_start];
+    const unsigned long long *bottom = &prefix[(size_t)height * cols + col_start];
+    
+    #pragma omp simd
+    for (int c = 0; c < n; c++) {
+        max_sums[c] = bottom[c] - top[c];
+    }
+    
+    for (long s = 1; s + height <= rows; s++) {
+        top += cols;
+        bottom += cols;
+        #pragma omp simd
+        for (int c = 0; c < n; c++) {
+            unsigned long long sum = bottom[c] - top[c];
+            max_sums[c] = (sum > max_sums[c]) ? sum : max_sums[c];
+        }
+    }
+}
+
+void max_window_sums_multi(const unsigned long long *prefix, long rows, int cols,
+                           const int *heights, int num_heights, unsigned long long *max_sums) {
+    int num_blocks = (cols + PART_A_COL_BLOCK - 1) / PART_A_COL_BLOCK;
+    
+    // Work per (height, block) shrinks with the height, so hand out dynamically
+    #pragma omp parallel for collapse(2) schedule(dynamic)
+    for (int h = 0; h < num_heights; h++) {
+        for (int cb = 0; cb < num_blocks; cb++) {
+            int col_start = cb * PART_A_COL_BLOCK;
+            int n = (col_start + PART_A_COL_BLOCK < cols) ? PART_A_COL_BLOCK : cols - col_start;
+            max_window_block(prefix, rows, cols, heights[h], col_start, n,
+                             &max_sums[(size_t)h * cols + col_start]);
+        }
+    }
+}
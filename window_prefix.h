@@ -0,0 +1,21 @@
+#ifndef WINDOW_PREFIX_H
+#define WINDOW_PREFIX_H
+
+// Multi-height Part A: column prefix sums are built once and every window
+// height is answered from them. Sums wrap modulo 2^64 exactly like the
+// sliding-window kernels, so results are bit-identical to one run per height.
+
+// Parse a comma separated list of window heights; returns the count (and a
+// malloc'd array in *heights) or -1 if the list is malformed
+int parse_window_heights(const char *list, int **heights);
+
+// Column prefix sums: prefix[r * cols + c] = sum of rows [0, r) of column c,
+// for r in [0, rows]. Built in parallel; the caller frees the result.
+unsigned long long* build_column_prefix(const unsigned long *heatmap, long rows, int cols);
+
+// Max window sum per column for each height: max_sums[h * cols + c] for
+// heights[h]. Work is split across threads per (height, column block).
+void max_window_sums_multi(const unsigned long long *prefix, long rows, int cols,
+                           const int *heights, int num_heights, unsigned long long *max_sums);
+
+#endif